@@ -0,0 +1,9 @@
+#!/bin/bash -ex
+
+pushd model_repository
+
+mkdir -p dali_bucketing/1
+python identity_pipeline.py dali_bucketing/1/model.dali
+echo "Bucketing model ready."
+
+popd
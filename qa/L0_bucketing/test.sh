@@ -0,0 +1,5 @@
+#!/bin/bash -ex
+
+: ${GRPC_ADDR:=${1:-"localhost:8001"}}
+
+python bucketing_client.py -u "$GRPC_ADDR"
@@ -0,0 +1,11 @@
+#!/bin/bash -ex
+
+pushd model_repository
+
+# Two versions with the same serialized pipeline, loaded at the same time
+mkdir -p dali_versions/1 dali_versions/2
+python identity_pipeline.py dali_versions/1/model.dali
+cp dali_versions/1/model.dali dali_versions/2/model.dali
+echo "Versioned model ready."
+
+popd
@@ -0,0 +1,12 @@
+#!/bin/bash -ex
+
+: ${GRPC_ADDR:=${1:-"localhost:8001"}}
+: ${SERVER_LOG:=${2:-""}}
+
+python versions_client.py -u "$GRPC_ADDR"
+
+# The versions are loaded at the same time, so neither takes over the other's pipelines
+if [ -n "$SERVER_LOG" ] && grep -q "takes over a running pipeline" "$SERVER_LOG"; then
+  echo "FAILED: a version took over the pipeline of another one"
+  exit 1
+fi
@@ -0,0 +1,101 @@
+#!/usr/bin/env python
+
+# The MIT License (MIT)
+#
+# Copyright (c) 2021 NVIDIA CORPORATION
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+import argparse, sys, queue
+import numpy as np
+from numpy.random import randint
+import tritongrpcclient
+
+np.random.seed(100019)
+
+
+def parse_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-v', '--verbose', action="store_true", required=False, default=False,
+                        help='Enable verbose output')
+    parser.add_argument('-u', '--url', type=str, required=False, default='localhost:8001',
+                        help='Inference server URL. Default is localhost:8001.')
+    parser.add_argument('--n_requests', type=int, required=False, default=256,
+                        help='Number of concurrent requests to each version')
+    parser.add_argument('--model_name', type=str, required=False, default="dali_versions",
+                        help='Model name')
+    return parser.parse_args()
+
+
+def main():
+    FLAGS = parse_args()
+    try:
+        triton_client = tritongrpcclient.InferenceServerClient(url=FLAGS.url, verbose=FLAGS.verbose)
+    except Exception as e:
+        print("channel creation failed: " + str(e))
+        sys.exit(1)
+
+    versions = ["1", "2"]
+    for version in versions:
+        if not triton_client.is_model_ready(model_name=FLAGS.model_name, model_version=version):
+            print("Model {} version {} is not ready".format(FLAGS.model_name, version))
+            sys.exit(1)
+
+    input_name = "DALI_INPUT_0"
+    output_name = "DALI_OUTPUT_0"
+    outputs = [tritongrpcclient.InferRequestedOutput(output_name)]
+
+    input_data = [randint(0, 255, size=(randint(1, 4), randint(1, 4096)), dtype='uint8')
+                  for _ in range(FLAGS.n_requests * len(versions))]
+
+    # Both versions serve at the same time. Each runs its own pipelines, even though the
+    # serialized pipelines are the same
+    results = queue.Queue()
+    for request_id, batch in enumerate(input_data):
+        inputs = [tritongrpcclient.InferInput(input_name, list(batch.shape), "UINT8")]
+        inputs[0].set_data_from_numpy(batch)
+        triton_client.async_infer(model_name=FLAGS.model_name,
+                                  model_version=versions[request_id % len(versions)],
+                                  inputs=inputs, outputs=outputs, request_id=str(request_id),
+                                  callback=lambda result, error, request_id=request_id:
+                                  results.put((request_id, result, error)))
+
+    for _ in range(len(input_data)):
+        request_id, result, error = results.get(timeout=60)
+        if error is not None:
+            print("Request {} failed: {}".format(request_id, error))
+            sys.exit(1)
+        output_data = result.as_numpy(output_name)
+        if not np.array_equal(output_data, input_data[request_id]):
+            print("Output of request {} does not match its input".format(request_id))
+            sys.exit(1)
+    print("pass")
+
+    for version in versions:
+        statistics = triton_client.get_inference_statistics(model_name=FLAGS.model_name,
+                                                            model_version=version)
+        stats = statistics.model_stats[0]
+        print("Version {}: requests: {}, executions: {}".format(version, stats.inference_count,
+                                                               stats.execution_count))
+        if stats.inference_count != FLAGS.n_requests:
+            print("FAILED: version {} didn't serve its requests".format(version))
+            sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
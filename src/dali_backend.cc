@@ -20,10 +20,23 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
 
+#include "src/dali_executor/cpu_affinity.h"
 #include "src/dali_executor/dali_executor.h"
 #include "src/dali_executor/io_buffer.h"
+#include "src/dali_executor/output_cache.h"
 #include "src/dali_executor/utils/dali.h"
 #include "src/dali_executor/utils/utils.h"
 #include "src/model_provider/model_provider.h"
@@ -51,8 +64,305 @@ struct ModelParameters {
     return result;
   }
 
+  /**
+   * Return a value of a parameter with a given `key`, or `def` if the parameter
+   * is not present. Values outside of [`min`, `max`] are rejected.
+   */
+  template<typename T>
+  T GetParam(const std::string& key, const T& def, const T& min, const T& max) {
+    T result = GetParam(key, def);
+    if (result < min || result > max) {
+      throw DaliBackendException(make_string("Parameter ", key, " = ", result,
+                                             " is out of range [", min, ", ", max, "]."));
+    }
+    return result;
+  }
+
+  /**
+   * Return the value, to which the parameter with a given `key` is mapped by `values`,
+   * or `def` if the parameter is not present.
+   */
+  template<typename T>
+  T GetEnumParam(const std::string& key, const T& def, const std::map<std::string, T>& values) {
+    if (!params_.Find(key.c_str()))
+      return def;
+    auto name = GetParam<std::string>(key);
+    auto it = values.find(name);
+    if (it == values.end()) {
+      std::string expected;
+      for (auto& value : values) {
+        expected += (expected.empty() ? "\"" : ", \"") + value.first + "\"";
+      }
+      throw DaliBackendException(make_string("Invalid value \"", name, "\" of parameter ", key,
+                                             ". Expected one of: ", expected, "."));
+    }
+    return it->second;
+  }
+
+  /**
+   * Return a size in bytes, e.g. "4096", "512KB" or "64MiB", given by the parameter
+   * with a given `key`, or `def` if the parameter is not present.
+   */
+  int64_t GetSizeParam(const std::string& key, int64_t def) {
+    if (!params_.Find(key.c_str()))
+      return def;
+    try {
+      return parse_size(GetParam<std::string>(key));
+    } catch (DaliBackendException& e) {
+      throw DaliBackendException(make_string("Invalid value of parameter ", key, ": ", e.what()));
+    }
+  }
+
+  /**
+   * Get the keys of the parameters, which are not used by the backend
+   * (e.g. misspelled), so that they can be reported.
+   */
+  std::vector<std::string> GetUnknownKeys() const {
+    static const char* const kKeys[] = {
+        "num_threads", "exec_async", "exec_pipelined", "prefetch_queue_depth", "no_copy_inputs",
+        "micro_batch_size", "warmup_batch_sizes", "share_pipeline", "cpu_affinity",
+        "parallel_instance_init", "latency_log_interval_sec", "pool_max_cached_mb",
+        "response_cache_mb", "copy_streams", "copy_threads", "staging_memory",
+        "standby_pipeline", "ready_sequence_pipelines", "memory_stats", "memory_budget",
+        "reuse_pipelines", "bucket_size_ratio", "reserve_staging"};
+    static const char* const kPrefixes[] = {"warmup_sample.", "input_device.", "input_format.",
+                                            "bytes_per_sample."};
+    std::vector<std::string> keys, unknown;
+    if (auto error = params_.Members(&keys)) {
+      TRITONSERVER_ErrorDelete(error);  // no parameters in the config
+      return unknown;
+    }
+    for (auto& key : keys) {
+      bool known = std::any_of(std::begin(kKeys), std::end(kKeys),
+                               [&](const char* k) { return key == k; }) ||
+                   std::any_of(std::begin(kPrefixes), std::end(kPrefixes),
+                               [&](const char* p) { return key.compare(0, strlen(p), p) == 0; });
+      if (!known)
+        unknown.push_back(key);
+    }
+    return unknown;
+  }
+
+  /**
+   * Number of DALI worker threads. -1 lets DALI choose.
+   */
   int GetNumThreads() {
-    return GetParam("num_threads", -1);
+    auto num_threads = GetParam("num_threads", -1, -1, 1024);
+    if (num_threads == 0)
+      throw DaliBackendException("Parameter num_threads has to be positive, or -1.");
+    return num_threads;
+  }
+
+  /**
+   * Number of the threads copying the inputs and outputs. 0 means as many as num_threads.
+   */
+  int GetCopyThreads() {
+    return GetParam("copy_threads", 0, 0, 1024);
+  }
+
+  /**
+   * Stage the host copies in the page-locked ("pinned") or the "pageable" memory.
+   */
+  bool GetPinnedStaging() {
+    return GetEnumParam<bool>("staging_memory", true, {{"pinned", true}, {"pageable", false}});
+  }
+
+  /**
+   * Asynchronous execution lets the backend start the next batch,
+   * while the outputs of the previous one are still being copied and sent.
+   */
+  bool GetExecAsync() {
+    return GetParam("exec_async", false);
+  }
+
+  bool GetExecPipelined() {
+    return GetParam("exec_pipelined", GetExecAsync());
+  }
+
+  int GetPrefetchQueueDepth() {
+    return GetParam("prefetch_queue_depth", GetExecAsync() ? 2 : 1, 1, 32);
+  }
+
+  /**
+   * Let DALI use the input buffers in place, instead of copying them.
+   */
+  bool GetNoCopyInputs() {
+    return GetParam("no_copy_inputs", false);
+  }
+
+  /**
+   * Batches larger than this are processed by the pipeline in parts.
+   * 0 means the max_batch_size of the model.
+   */
+  int GetMicroBatchSize() {
+    return GetParam("micro_batch_size", 0, 0, std::numeric_limits<int>::max());
+  }
+
+  /**
+   * Batch sizes to run the pipeline with at load time, e.g. "1,8,32".
+   * An empty list disables the warm-up.
+   */
+  std::vector<int> GetWarmupBatchSizes() {
+    std::stringstream list(GetParam<std::string>("warmup_batch_sizes", ""));
+    std::vector<int> result;
+    std::string item;
+    while (std::getline(list, item, ',')) {
+      if (!item.empty())
+        result.push_back(from_string<int>(item));
+      if (!result.empty() && result.back() < 1)
+        throw DaliBackendException("Parameter warmup_batch_sizes has to list positive sizes.");
+    }
+    return result;
+  }
+
+  /**
+   * Path (absolute, or relative to the model version directory) to a file with a sample
+   * of a given input, used for the warm-up. The content of the file is the raw sample data.
+   * Empty means that a zero-filled sample is generated.
+   */
+  std::string GetWarmupSample(const std::string& input_name) {
+    return GetParam<std::string>("warmup_sample." + input_name, "");
+  }
+
+  /**
+   * Let all the instances on the same device use one pipeline (and its thread pool),
+   * instead of creating their own.
+   */
+  bool GetSharePipeline() {
+    return GetParam("share_pipeline", false);
+  }
+
+  /**
+   * CPUs running the work of an instance: its Execute thread, DALI workers and copy threads.
+   * "auto" - the NUMA node closest to the instance's GPU, "none" - no binding,
+   * or a list of CPUs, e.g. "0-7,16-23".
+   */
+  std::string GetCpuAffinity() {
+    return GetParam<std::string>("cpu_affinity", "auto");
+  }
+
+  /**
+   * Create the pipelines of all the instances concurrently, when the model is loaded.
+   */
+  bool GetParallelInstanceInit() {
+    return GetParam("parallel_instance_init", false);
+  }
+
+  /**
+   * Interval (in seconds) of logging the latency histograms of the processing stages.
+   * 0 disables the logging.
+   */
+  int GetLatencyLogInterval() {
+    return GetParam("latency_log_interval_sec", 0, 0, std::numeric_limits<int>::max());
+  }
+
+  /**
+   * Upper bound (in MiB) for the memory cached by the intermediate buffers pools.
+   * The pools are shared by all instances, so the smallest limit applies. -1 means no limit.
+   */
+  int GetPoolMaxCachedMB() {
+    return GetParam("pool_max_cached_mb", -1, -1, std::numeric_limits<int>::max());
+  }
+
+  /**
+   * Capacity (in MiB) of the cache of the outputs produced for repeated inputs. 0 disables it.
+   */
+  int GetResponseCacheMB() {
+    return GetParam("response_cache_mb", 0, 0, std::numeric_limits<int>::max());
+  }
+
+  /**
+   * Number of CUDA streams, across which the copies of the outputs are spread.
+   */
+  int GetCopyStreams() {
+    return GetParam("copy_streams", 4, 1, 64);
+  }
+
+  /**
+   * Keep a standby instance of the pipeline, which takes over when a run fails,
+   * while the failed one is rebuilt in the background.
+   */
+  bool GetStandbyPipeline() {
+    return GetParam("standby_pipeline", false);
+  }
+
+  /**
+   * Collect the memory statistics of the pipelines, reported in the logs and the metrics.
+   */
+  bool GetMemoryStats() {
+    return GetParam("memory_stats", false) || GetMemoryBudget() > 0;
+  }
+
+  /**
+   * Memory, in bytes, which a batch of each instance is predicted to need at most
+   * (e.g. "2GB"). Larger batches are split and larger requests are rejected. 0 means no limit.
+   */
+  int64_t GetMemoryBudget() {
+    auto budget = GetSizeParam("memory_budget", 0);
+    ENFORCE(budget >= 0, "Parameter memory_budget can't be negative.");
+    return budget;
+  }
+
+  /**
+   * Requests in a batch, whose samples differ in size more than this many times, are run
+   * in separate parts. 0 disables the bucketing.
+   */
+  int GetBucketSizeRatio() {
+    auto ratio = GetParam("bucket_size_ratio", 0, 0, 1 << 20);
+    ENFORCE(ratio == 0 || ratio >= 2, "Parameter bucket_size_ratio has to be 0 or at least 2.");
+    return ratio;
+  }
+
+  /**
+   * Let a reloaded model take over the running pipelines of its predecessor, if the serialized
+   * pipeline and the settings of the executors didn't change.
+   */
+  bool GetReusePipelines() {
+    return GetParam("reuse_pipelines", true);
+  }
+
+  /**
+   * Number of pipelines each instance of a model with the sequence batcher keeps built
+   * in the background, ready for the next sequences.
+   */
+  int GetReadySequencePipelines() {
+    return GetParam("ready_sequence_pipelines", 1, 0, 64);
+  }
+
+  /**
+   * Check if the samples of a given input are encoded images. It's configured with
+   * the "input_format.<input name>" parameter ("raw" or "image"). Requests with samples of
+   * an "image" input that don't look like images are rejected before they're batched.
+   */
+  bool GetInputIsImage(const std::string& input_name) {
+    return GetEnumParam<bool>("input_format." + input_name, false,
+                              {{"raw", false}, {"image", true}});
+  }
+
+  /**
+   * Get the expected size of a sample of an input or output with a given name. It's configured
+   * with the "bytes_per_sample.<name>" parameter, e.g. "600KB". 0 if not given.
+   */
+  int64_t GetBytesPerSample(const std::string& name) {
+    return GetSizeParam("bytes_per_sample." + name, 0);
+  }
+
+  /**
+   * Reserve the staging buffers of the inputs and outputs with all the dims fixed in the config,
+   * as if their bytes_per_sample were given.
+   */
+  bool GetReserveStaging() {
+    return GetParam("reserve_staging", false);
+  }
+
+  /**
+   * Return the device, on which the DALI pipeline consumes an input with a given name.
+   * It's configured with the "input_device.<input name>" parameter ("cpu" or "gpu").
+   * Inputs without the parameter are consumed on the CPU.
+   */
+  device_type_t GetInputDevice(const std::string& input_name) {
+    return GetEnumParam("input_device." + input_name, device_type_t::CPU,
+                        {{"cpu", device_type_t::CPU}, {"gpu", device_type_t::GPU}});
   }
 
  private:
@@ -64,13 +374,129 @@ struct ModelParameters {
       TRITON_CALL_GUARD(params_.MemberAsObject(key_c, &param));
       std::string string_value;
       TRITON_CALL_GUARD(param.MemberAsString("string_value", &string_value));
-      value = from_string<T>(string_value);
+      try {
+        value = from_string<T>(string_value);
+      } catch (DaliBackendException& e) {
+        throw DaliBackendException(
+            make_string("Invalid value of parameter ", key, ": ", e.what()));
+      }
     }
   }
 
   common::TritonJson::Value params_;
 };
 
+/**
+ * Executor used by one or more instances. The instances take turns on the mutex.
+ */
+struct SharedExecutor {
+  explicit SharedExecutor(std::unique_ptr<DaliExecutor> executor) :
+      executor(std::move(executor)) {}
+
+  std::unique_ptr<DaliExecutor> executor;
+  std::mutex mutex;
+};
+
+/**
+ * Running executors of the loaded models, by the model version, the hash of the serialized
+ * pipeline and the settings of the executor. A reloaded version with the same pipeline takes
+ * the executors over from its predecessor, instead of building and warming up new ones.
+ * Thread-safe.
+ */
+class ExecutorRegistry {
+ public:
+  static ExecutorRegistry& Get() {
+    static ExecutorRegistry registry;
+    return registry;
+  }
+
+  /**
+   * @brief Register an executor of the model loaded as the \p generation.
+   */
+  void Add(const std::string& key, uint64_t generation,
+           const std::shared_ptr<SharedExecutor>& executor) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RemoveExpired();
+    entries_.emplace(key, Entry{executor, generation});
+  }
+
+  /**
+   * @brief Take over an executor registered by a model loaded before the \p generation.
+   * @return nullptr, if there's none with the \p key.
+   */
+  std::shared_ptr<SharedExecutor> Adopt(const std::string& key, uint64_t generation) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RemoveExpired();
+    auto range = entries_.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.generation >= generation)
+        continue;
+      auto executor = it->second.executor.lock();
+      if (!executor)
+        continue;  // released in the meantime
+      it->second.generation = generation;
+      return executor;
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Count the executors, which a model loaded as the \p generation could take over.
+   */
+  size_t CountAdoptable(const std::string& key, uint64_t generation) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RemoveExpired();
+    auto range = entries_.equal_range(key);
+    return std::count_if(range.first, range.second,
+                         [&](const auto& entry) { return entry.second.generation < generation; });
+  }
+
+  /**
+   * @brief Get the generation of a newly loaded model, later than all the previous ones.
+   */
+  static uint64_t NextGeneration() {
+    static std::atomic<uint64_t> next{1};
+    return next++;
+  }
+
+ private:
+  struct Entry {
+    std::weak_ptr<SharedExecutor> executor;
+    uint64_t generation;  // of the model using the executor
+  };
+
+  void RemoveExpired() {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->second.executor.expired())
+        it = entries_.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  std::mutex mutex_;
+  std::multimap<std::string, Entry> entries_;
+};
+
+/**
+ * Model input, as declared in the config. Inputs are fed to the external sources of the same name.
+ */
+struct InputBinding {
+  std::string name;
+  dali_data_type_t type;
+  device_type_t device;       // on which the pipeline consumes the input
+  std::vector<int64_t> dims;  // of a sample, -1 for variable; empty if not checked
+  bool is_image;              // samples are encoded images
+};
+
+/**
+ * Model output, as declared in the config.
+ */
+struct OutputBinding {
+  std::string name;
+  int output_idx;  // index of the pipeline output
+};
+
 class DaliModel : public ::triton::backend::BackendModel {
  public:
   static TRITONSERVER_Error* Create(TRITONBACKEND_Model* triton_model, DaliModel** state);
@@ -84,6 +510,17 @@ class DaliModel : public ::triton::backend::BackendModel {
     LOG_MESSAGE(TRITONSERVER_LOG_INFO,
                 (std::string("model configuration:\n") + buffer.Contents()).c_str());
 
+    try {
+      ValidateParameters();
+      ReadBindings();
+      ReadWarmupSamples();
+      auto cache_mb = params_.GetResponseCacheMB();
+      if (cache_mb > 0)
+        output_cache_ = std::make_unique<OutputCache>(static_cast<size_t>(cache_mb) << 20);
+    } catch (const std::exception& e) {
+      return TRITONSERVER_ErrorNew(TRITONSERVER_ERROR_INVALID_ARG, e.what());
+    }
+
     return nullptr;  // success
   }
 
@@ -91,27 +528,289 @@ class DaliModel : public ::triton::backend::BackendModel {
     return *dali_model_provider_;
   };
 
+  /**
+   * @brief Read all the model-wide parameters, so that an invalid value fails the model load
+   *        instead of the creation of an instance or the first request.
+   */
+  void ValidateParameters() {
+    for (auto& key : params_.GetUnknownKeys()) {
+      LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                  make_string("Unknown parameter ", key, " of model ", Name(), " is ignored.")
+                      .c_str());
+    }
+    auto config = GetExecutorConfig();
+    ENFORCE(!config.async || config.pipelined,
+            "Parameter exec_async requires exec_pipelined to be true.");
+    ENFORCE(!config.async || config.prefetch_queue_depth > 1,
+            "Parameter exec_async requires prefetch_queue_depth of at least 2.");
+    if (config.cpu_affinity != "auto" && config.cpu_affinity != "none")
+      ParseCpuList(config.cpu_affinity);
+    params_.GetSharePipeline();
+    params_.GetParallelInstanceInit();
+    params_.GetLatencyLogInterval();
+    params_.GetResponseCacheMB();
+    params_.GetReadySequencePipelines();
+    params_.GetMemoryBudget();
+    params_.GetReusePipelines();
+    params_.GetBucketSizeRatio();
+    GetSequenceIdleTimeoutNs();
+  }
+
   ModelParameters& GetModelParamters() {
     return params_;
   }
 
 
-  void ReadOutputsOrder() {
+  /**
+   * @brief Inputs of the model, in the order of the config.
+   */
+  const std::vector<InputBinding>& GetInputBindings() const {
+    return input_bindings_;
+  }
+
+
+  /**
+   * @brief Names of the control inputs of the sequence batcher.
+   *
+   * The sequence batcher adds them to the requests, but they aren't inputs of the pipeline.
+   */
+  const std::vector<std::string>& GetControlInputs() const {
+    return control_inputs_;
+  }
+
+
+  /**
+   * @brief Outputs of the model, in the order of the config.
+   */
+  const std::vector<OutputBinding>& GetOutputBindings() const {
+    return output_bindings_;
+  }
+
+
+  /**
+   * @brief Get the cache of the outputs shared by the instances.
+   * @return nullptr, if the cache is disabled.
+   */
+  OutputCache* GetOutputCache() const {
+    return output_cache_.get();
+  }
+
+
+  /**
+   * @brief Get the expected size of a whole batch (at the max batch size) of each input
+   *        or output of the config, depending on the `member` ("input" or "output").
+   *
+   * The size of a sample is given by the bytes_per_sample.<name> parameter or, with
+   * the reserve_staging parameter, computed from the dims and the type, if all the dimensions
+   * are fixed. 0 if it's not known.
+   */
+  std::vector<size_t> ReadBatchBytes(const char* member) {
     using Value = ::triton::common::TritonJson::Value;
-    Value outputs;
-    model_config_.MemberAsArray("output", &outputs);
-    for (size_t output_idx = 0; output_idx < outputs.ArraySize(); output_idx++) {
-      Value out;
-      std::string name;
-      outputs.IndexAsObject(output_idx, &out);
-      out.MemberAsString("name", &name);
-      output_order_[name] = output_idx;
+    Value items;
+    model_config_.MemberAsArray(member, &items);
+    std::vector<size_t> batch_bytes(items.ArraySize());
+    int64_t batch_size = std::max(MaxBatchSize(), 1);
+    bool reserve_fixed = params_.GetReserveStaging();
+    for (size_t idx = 0; idx < items.ArraySize(); idx++) {
+      Value item;
+      std::string name, data_type;
+      TRITON_CALL_GUARD(items.IndexAsObject(idx, &item));
+      TRITON_CALL_GUARD(item.MemberAsString("name", &name));
+      TRITON_CALL_GUARD(item.MemberAsString("data_type", &data_type));
+      int64_t sample_bytes = params_.GetBytesPerSample(name);
+      auto triton_type = ModelConfigDataTypeToTritonServerDataType(data_type);
+      if (sample_bytes == 0 && reserve_fixed && triton_type != TRITONSERVER_TYPE_BYTES) {
+        std::vector<int64_t> dims;
+        TRITON_CALL_GUARD(ParseShape(item, "dims", &dims));
+        if (std::all_of(dims.begin(), dims.end(), [](int64_t d) { return d >= 0; }))
+          sample_bytes = volume(dims) * dali_type_size(to_dali(triton_type));
+      }
+      ENFORCE(sample_bytes <= std::numeric_limits<int64_t>::max() / batch_size,
+              make_string("The batch of ", member, " ", name, " (", sample_bytes,
+                          " bytes per sample, ", batch_size, " samples) is too large."));
+      batch_bytes[idx] = static_cast<size_t>(sample_bytes * batch_size);
     }
+    return batch_bytes;
   }
 
 
-  const std::unordered_map<std::string, int>& GetOutputOrder() const {
-    return output_order_;
+  /**
+   * @brief Get an executor for a new instance on a given device.
+   *
+   * Executors prebuilt with PrebuildExecutors() are handed out first.
+   * Otherwise a new one is created.
+   */
+  std::unique_ptr<DaliExecutor> TakeExecutor(int device_id) {
+    std::future<std::unique_ptr<DaliExecutor>> prebuilt;
+    {
+      std::lock_guard<std::mutex> lock(prebuilt_mutex_);
+      auto it = prebuilt_executors_.find(device_id);
+      if (it != prebuilt_executors_.end()) {
+        prebuilt = std::move(it->second);
+        prebuilt_executors_.erase(it);
+      }
+    }
+    if (prebuilt.valid())
+      return prebuilt.get();
+    return CreateExecutor(GetExecutorConfig(), device_id);
+  }
+
+
+  /**
+   * @brief Get the CPUs, to which the threads working for a given device should be bound.
+   *
+   * Only the CPUs the process is allowed to run on are kept, e.g. within a container's cpuset.
+   * @param spec Value of the cpu_affinity parameter.
+   * @return Empty list, if the threads shouldn't be bound.
+   */
+  static std::vector<int> ResolveCpuAffinity(const std::string& spec, int device_id) {
+    if (spec == "none")
+      return {};
+    auto cpus = spec == "auto" ? GetDeviceLocalCpus(device_id) : ParseCpuList(spec);
+    if (cpus.empty())
+      return {};
+    auto allowed = IntersectCpus(cpus, GetAllowedCpus());
+    if (allowed.empty()) {
+      LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                  make_string("None of the CPUs of cpu_affinity=", spec,
+                              " is allowed for the process. The threads are not bound.")
+                      .c_str());
+    }
+    return allowed;
+  }
+
+
+  /**
+   * @brief Get an executor for an instance on a given device.
+   *
+   * With the share_pipeline parameter, all the instances on a device get the same executor.
+   */
+  std::shared_ptr<SharedExecutor> AcquireExecutor(int device_id) {
+    if (!params_.GetSharePipeline())
+      return AdoptOrCreateExecutor(device_id);
+    std::lock_guard<std::mutex> lock(shared_executors_mutex_);
+    auto& entry = shared_executors_[device_id];
+    auto shared = entry.lock();
+    if (!shared) {
+      shared = AdoptOrCreateExecutor(device_id);
+      entry = shared;
+    }
+    return shared;
+  }
+
+
+  /**
+   * @brief Take over a running executor of the previously loaded model with the same pipeline
+   *        and settings, with the reuse_pipelines parameter. Otherwise, get a new one.
+   */
+  std::shared_ptr<SharedExecutor> AdoptOrCreateExecutor(int device_id) {
+    if (!params_.GetReusePipelines())
+      return std::make_shared<SharedExecutor>(TakeExecutor(device_id));
+    auto key = ExecutorKey(GetExecutorConfig(), device_id);
+    auto& registry = ExecutorRegistry::Get();
+    if (auto adopted = registry.Adopt(key, generation_)) {
+      LOG_MESSAGE(TRITONSERVER_LOG_INFO,
+                  make_string("Model ", Name(), " version ", Version(),
+                              " takes over a running pipeline on device ", device_id, ".")
+                      .c_str());
+      return adopted;
+    }
+    auto shared = std::make_shared<SharedExecutor>(TakeExecutor(device_id));
+    registry.Add(key, generation_, shared);
+    return shared;
+  }
+
+
+  /**
+   * @brief Check if the model is served with the sequence batcher.
+   *
+   * The requests of each sequence then run on a pipeline of their own,
+   * so that the state of the pipeline carries over between the requests of the sequence.
+   */
+  bool IsSequenceModel() {
+    return model_config_.Find("sequence_batching");
+  }
+
+
+  /**
+   * @brief Get the time, after which Triton drops an idle sequence, in nanoseconds.
+   */
+  int64_t GetSequenceIdleTimeoutNs() {
+    uint64_t idle_us = 1000000;  // default of the sequence batcher
+    common::TritonJson::Value sequence_batching;
+    if (model_config_.Find("sequence_batching", &sequence_batching) &&
+        sequence_batching.Find("max_sequence_idle_microseconds")) {
+      TRITON_CALL_GUARD(
+          sequence_batching.MemberAsUInt("max_sequence_idle_microseconds", &idle_us));
+    }
+    return static_cast<int64_t>(idle_us) * 1000;
+  }
+
+
+  /**
+   * @brief Create an executor for a new sequence on a given device.
+   *
+   * The executor is not warmed up, so that its pipeline starts with a clean state.
+   */
+  std::unique_ptr<DaliExecutor> CreateSequenceExecutor(int device_id) {
+    auto config = GetExecutorConfig();
+    config.warmup_batch_sizes.clear();
+    return CreateExecutor(config, device_id);
+  }
+
+
+  /**
+   * @brief Start creating the executors of all the instances from the instance_group
+   *        in the background, if the parallel_instance_init parameter is set.
+   */
+  void PrebuildExecutors() {
+    if (!params_.GetParallelInstanceInit() || IsSequenceModel())
+      return;
+    using Value = ::triton::common::TritonJson::Value;
+    auto config = GetExecutorConfig();
+    Value groups;
+    if (!model_config_.Find("instance_group", &groups))
+      return;
+    std::lock_guard<std::mutex> lock(prebuilt_mutex_);
+    for (size_t group_idx = 0; group_idx < groups.ArraySize(); group_idx++) {
+      Value group;
+      TRITON_CALL_GUARD(groups.IndexAsObject(group_idx, &group));
+      std::string kind;
+      int64_t count = 1;
+      group.MemberAsString("kind", &kind);
+      group.MemberAsInt("count", &count);
+      std::vector<int> devices;
+      if (kind == "KIND_CPU") {
+        devices.push_back(::dali::CPU_ONLY_DEVICE_ID);
+      } else if (kind == "KIND_GPU") {
+        Value gpus;
+        if (group.Find("gpus", &gpus)) {
+          for (size_t gpu_idx = 0; gpu_idx < gpus.ArraySize(); gpu_idx++) {
+            int64_t gpu;
+            TRITON_CALL_GUARD(gpus.IndexAsInt(gpu_idx, &gpu));
+            devices.push_back(gpu);
+          }
+        }
+      }
+      if (params_.GetSharePipeline()) {
+        count = 1;  // the instances on a device share one executor
+      }
+      for (int device_id : devices) {
+        if (params_.GetSharePipeline() && prebuilt_executors_.count(device_id))
+          continue;
+        int64_t adoptable = 0;
+        if (params_.GetReusePipelines()) {
+          adoptable = static_cast<int64_t>(ExecutorRegistry::Get().CountAdoptable(
+              ExecutorKey(config, device_id), generation_));
+        }
+        for (int64_t i = adoptable; i < count; i++) {
+          prebuilt_executors_.emplace(
+              device_id, std::async(std::launch::async, [this, config, device_id]() {
+                return CreateExecutor(config, device_id);
+              }));
+        }
+      }
+    }
   }
 
 
@@ -125,12 +824,15 @@ class DaliModel : public ::triton::backend::BackendModel {
     TRITON_CALL_GUARD(
         TRITONBACKEND_ModelRepository(triton_model_, &artifact_type, &model_repo_path));
 
+    model_version_dir_ = make_string(model_repo_path, sep, version_);
     std::stringstream dali_pipeline_path;
-    dali_pipeline_path << model_repo_path << sep << version_ << sep << GetModelFilename();
+    dali_pipeline_path << model_version_dir_ << sep << GetModelFilename();
     std::string filename = dali_pipeline_path.str();
     LOG_MESSAGE(TRITONSERVER_LOG_INFO,
                 (make_string("Loading DALI pipeline from file ", filename).c_str()));
     dali_model_provider_ = std::make_unique<FileModelProvider>(filename);
+    pipeline_hash_ = HashData(dali_model_provider_->GetModel().get(),
+                              dali_model_provider_->GetModelSize());
   }
 
   std::string GetModelFilename() {
@@ -139,9 +841,252 @@ class DaliModel : public ::triton::backend::BackendModel {
     return ret.empty() ? "model.dali" : ret;
   }
 
+  /**
+   * @brief Settings of the executors, read from the parameters once,
+   *        so that the executors can be created concurrently.
+   */
+  struct ExecutorConfig {
+    int max_batch_size = 0;
+    int num_threads = -1;
+    bool pipelined = false;
+    bool async = false;
+    int prefetch_queue_depth = 1;
+    bool memory_stats = false;
+    ExecutorOptions options{};
+    std::vector<int> warmup_batch_sizes{};
+    std::string cpu_affinity{};
+  };
+
+  /**
+   * @brief Get the key of the executors of the model in the ExecutorRegistry.
+   *
+   * Executors with the same key run the same pipeline of the same version of the model with
+   * the same settings. The versions loaded at the same time never share their executors.
+   */
+  std::string ExecutorKey(const ExecutorConfig& config, int device_id) const {
+    const auto& opts = config.options;
+    std::stringstream ss;
+    ss << Name() << ":" << Version() << ":" << pipeline_hash_ << ":"
+       << dali_model_provider_->GetModelSize() << ":"
+       << device_id << ":" << config.max_batch_size << ":" << config.num_threads << ":"
+       << config.pipelined << ":" << config.async << ":" << config.prefetch_queue_depth << ":"
+       << config.memory_stats << ":" << config.cpu_affinity << ":" << opts.no_copy_inputs << ":"
+       << opts.pinned_staging << ":" << opts.max_cached_bytes << ":" << opts.micro_batch_size
+       << ":" << opts.num_copy_streams << ":" << opts.num_copy_threads << ":"
+       << opts.standby_pipeline << ":";
+    for (auto& input : opts.input_batch_bytes) {
+      ss << static_cast<int>(input.first) << "/" << input.second << ",";
+    }
+    ss << ":";
+    for (auto bytes : opts.output_batch_bytes) {
+      ss << bytes << ",";
+    }
+    return ss.str();
+  }
+
+  ExecutorConfig GetExecutorConfig() {
+    using Value = ::triton::common::TritonJson::Value;
+    ExecutorConfig config{};
+    config.max_batch_size = MaxBatchSize();
+    config.num_threads = params_.GetNumThreads();
+    config.pipelined = params_.GetExecPipelined();
+    config.async = params_.GetExecAsync();
+    config.prefetch_queue_depth = params_.GetPrefetchQueueDepth();
+    config.memory_stats = params_.GetMemoryStats();
+    config.options.no_copy_inputs = params_.GetNoCopyInputs();
+    config.options.micro_batch_size = params_.GetMicroBatchSize();
+    config.options.num_copy_streams = params_.GetCopyStreams();
+    config.options.standby_pipeline = params_.GetStandbyPipeline();
+    config.options.num_copy_threads = params_.GetCopyThreads();
+    config.options.pinned_staging = params_.GetPinnedStaging();
+    auto input_bytes = ReadBatchBytes("input");
+    if (!model_config_.Find("dynamic_batching")) {
+      // Each batch is a single request, the inputs of which are passed to DALI without staging
+      std::fill(input_bytes.begin(), input_bytes.end(), 0);
+    }
+    Value inputs;
+    model_config_.MemberAsArray("input", &inputs);
+    for (size_t input_idx = 0; input_idx < input_bytes.size(); input_idx++) {
+      Value inp;
+      std::string name;
+      TRITON_CALL_GUARD(inputs.IndexAsObject(input_idx, &inp));
+      TRITON_CALL_GUARD(inp.MemberAsString("name", &name));
+      config.options.input_batch_bytes.emplace_back(params_.GetInputDevice(name),
+                                                    input_bytes[input_idx]);
+    }
+    config.options.output_batch_bytes = ReadBatchBytes("output");
+    auto max_cached_mb = params_.GetPoolMaxCachedMB();
+    config.options.max_cached_bytes =
+        max_cached_mb < 0 ? -1 : static_cast<int64_t>(max_cached_mb) << 20;
+    config.warmup_batch_sizes = params_.GetWarmupBatchSizes();
+    config.cpu_affinity = params_.GetCpuAffinity();
+    return config;
+  }
+
+  /**
+   * @brief Create an executor of the model's pipeline on a given device and warm it up.
+   *
+   * The threads of the executor are bound to the CPUs given by the cpu_affinity parameter.
+   * A failed warm-up is not an error, the pipeline is reset and can still process requests.
+   */
+  std::unique_ptr<DaliExecutor> CreateExecutor(const ExecutorConfig& config, int device_id) {
+    DeviceGuard dg(device_id);
+    // The threads started by DALI and the executor inherit the affinity
+    ScopedThreadAffinity affinity(ResolveCpuAffinity(config.cpu_affinity, device_id));
+    if (!affinity.Succeeded()) {
+      LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                  make_string("Failed to bind the threads of ", Name(),
+                              " to the CPUs of cpu_affinity=", config.cpu_affinity,
+                              ". The threads are not bound.")
+                      .c_str());
+    }
+    DaliPipeline pipeline(dali_model_provider_->GetModel(), dali_model_provider_->GetModelSize(),
+                          config.max_batch_size, config.num_threads, device_id, config.pipelined,
+                          config.async, config.prefetch_queue_depth, config.memory_stats);
+    size_t gpu_input_bytes = 0;
+    for (auto& input : config.options.input_batch_bytes) {
+      if (input.first == device_type_t::GPU)
+        gpu_input_bytes += input.second;
+    }
+    // DALI keeps copies of the GPU inputs, so its pool gets the memory for them up front
+    pipeline.PreallocateDeviceMemory(gpu_input_bytes);
+    auto executor = std::make_unique<DaliExecutor>(std::move(pipeline), config.options);
+    if (!config.warmup_batch_sizes.empty()) {
+      try {
+        executor->WarmUp(warmup_samples_, config.warmup_batch_sizes);
+      } catch (const std::exception& e) {
+        LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                    make_string("Warm-up of ", Name(), " failed: ", e.what()).c_str());
+      }
+    }
+    if (executor->ReservationExceedsCache()) {
+      LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                  make_string("The staging buffers reserved for ", Name(),
+                              " exceed the limit of the cached memory of the pools "
+                              "(pool_max_cached_mb), so they're not kept.")
+                      .c_str());
+    }
+    return executor;
+  }
+
+  /**
+   * @brief Prepare a sample of every input for the warm-up.
+   *
+   * The samples are read from the files given with warmup_sample.<name> parameters.
+   * The other inputs get zero-filled samples shaped as in the config (with 1 for the
+   * variable dimensions).
+   */
+  void ReadWarmupSamples() {
+    if (params_.GetWarmupBatchSizes().empty())
+      return;
+    using Value = ::triton::common::TritonJson::Value;
+    Value inputs;
+    model_config_.MemberAsArray("input", &inputs);
+    for (size_t input_idx = 0; input_idx < inputs.ArraySize(); input_idx++) {
+      Value inp;
+      std::string name, data_type;
+      TRITON_CALL_GUARD(inputs.IndexAsObject(input_idx, &inp));
+      TRITON_CALL_GUARD(inp.MemberAsString("name", &name));
+      TRITON_CALL_GUARD(inp.MemberAsString("data_type", &data_type));
+      std::vector<int64_t> dims;
+      TRITON_CALL_GUARD(ParseShape(inp, "dims", &dims));
+      auto type = to_dali(ModelConfigDataTypeToTritonServerDataType(data_type));
+      auto type_size = dali_type_size(type);
+      auto data = std::make_shared<std::vector<char>>();
+      TensorShape<> shape;
+      auto filename = params_.GetWarmupSample(name);
+      if (!filename.empty()) {
+        if (filename[0] != '/')
+          filename = model_version_dir_ + "/" + filename;
+        std::ifstream fin(filename, std::ios::binary);
+        ENFORCE(fin, make_string("Failed to open warm-up sample file: ", filename));
+        data->assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+        ENFORCE(data->size() % type_size == 0,
+                make_string("Size of the warm-up sample ", filename, " is not a multiple of ",
+                            "the size of the type of input ", name, "."));
+        shape = TensorShape<>(static_cast<int64_t>(data->size() / type_size));
+        if (dims.size() != 1 && volume(dims) * type_size == static_cast<int64_t>(data->size()))
+          shape = TensorShape<>(dims);
+      } else {
+        for (auto& dim : dims) {
+          if (dim < 0)
+            dim = 1;
+        }
+        shape = TensorShape<>(dims);
+        data->resize(volume(shape) * type_size);
+      }
+      IDescr sample;
+      sample.meta.name = name;
+      sample.meta.type = type;
+      sample.meta.shape = TensorListShape<>::make_uniform(1, shape);
+      IBufferDescr buffer;
+      buffer.device = device_type_t::CPU;
+      buffer.data = data->data();
+      buffer.size = data->size();
+      sample.buffers = {buffer};
+      warmup_samples_.push_back(std::move(sample));
+      warmup_data_.push_back(std::move(data));
+    }
+  }
+
+  /**
+   * @brief Resolve the inputs and outputs of the config, so that the requests
+   *        can be processed without looking them up by name.
+   */
+  void ReadBindings() {
+    using Value = ::triton::common::TritonJson::Value;
+    Value inputs;
+    model_config_.MemberAsArray("input", &inputs);
+    for (size_t input_idx = 0; input_idx < inputs.ArraySize(); input_idx++) {
+      Value inp;
+      std::string name, data_type;
+      TRITON_CALL_GUARD(inputs.IndexAsObject(input_idx, &inp));
+      TRITON_CALL_GUARD(inp.MemberAsString("name", &name));
+      TRITON_CALL_GUARD(inp.MemberAsString("data_type", &data_type));
+      auto type = to_dali(ModelConfigDataTypeToTritonServerDataType(data_type));
+      std::vector<int64_t> dims;
+      if (!inp.Find("reshape"))
+        TRITON_CALL_GUARD(ParseShape(inp, "dims", &dims));
+      input_bindings_.push_back({name, type, params_.GetInputDevice(name), std::move(dims),
+                                 params_.GetInputIsImage(name)});
+    }
+    Value outputs;
+    model_config_.MemberAsArray("output", &outputs);
+    for (size_t output_idx = 0; output_idx < outputs.ArraySize(); output_idx++) {
+      Value out;
+      std::string name;
+      TRITON_CALL_GUARD(outputs.IndexAsObject(output_idx, &out));
+      TRITON_CALL_GUARD(out.MemberAsString("name", &name));
+      output_bindings_.push_back({name, static_cast<int>(output_idx)});
+    }
+    Value sequence_batching, controls;
+    if (model_config_.Find("sequence_batching", &sequence_batching) &&
+        sequence_batching.Find("control_input", &controls)) {
+      for (size_t control_idx = 0; control_idx < controls.ArraySize(); control_idx++) {
+        Value control;
+        std::string name;
+        TRITON_CALL_GUARD(controls.IndexAsObject(control_idx, &control));
+        TRITON_CALL_GUARD(control.MemberAsString("name", &name));
+        control_inputs_.push_back(name);
+      }
+    }
+  }
+
   ModelParameters params_;
   std::unique_ptr<ModelProvider> dali_model_provider_;
-  std::unordered_map<std::string, int> output_order_;
+  uint64_t pipeline_hash_ = 0;  // of the serialized pipeline
+  const uint64_t generation_ = ExecutorRegistry::NextGeneration();
+  std::vector<InputBinding> input_bindings_;
+  std::vector<OutputBinding> output_bindings_;
+  std::vector<std::string> control_inputs_;  // added to the requests by the sequence batcher
+  std::unique_ptr<OutputCache> output_cache_;
+  std::string model_version_dir_;
+  std::vector<IDescr> warmup_samples_;
+  std::vector<std::shared_ptr<std::vector<char>>> warmup_data_;
+  std::mutex prebuilt_mutex_;
+  std::multimap<int, std::future<std::unique_ptr<DaliExecutor>>> prebuilt_executors_;
+  std::mutex shared_executors_mutex_;
+  std::map<int, std::weak_ptr<SharedExecutor>> shared_executors_;
 };
 
 
@@ -158,9 +1103,118 @@ TRITONSERVER_Error* DaliModel::Create(TRITONBACKEND_Model* triton_model, DaliMod
   return error;
 }
 
+/**
+ * Backend-wide settings, given with --backend-config=dali,<key>=<value>.
+ */
+struct DaliBackendState {
+  DaliInitOptions init_options{};
+  int64_t pool_max_cached_bytes = -1;  // limit of the intermediate buffers pools, if not negative
+  TritonGaugeFamily memory_gauges{};   // memory of the instances, with the memory_stats parameter
+
+  /**
+   * @brief Read the settings from the "cmdline" section of the backend config.
+   */
+  void ParseConfig(common::TritonJson::Value& backend_config) {
+    common::TritonJson::Value cmdline;
+    if (!backend_config.Find("cmdline", &cmdline))
+      return;
+    std::vector<std::string> keys;
+    TRITON_CALL_GUARD(cmdline.Members(&keys));
+    // DALI memory settings, that are configured through the environment
+    const std::unordered_map<std::string, std::string> dali_env = {
+        {"device_memory_pool", "DALI_USE_DEVICE_MEM_POOL"},
+        {"pinned_memory_pool", "DALI_USE_PINNED_MEM_POOL"},
+        {"use_vmm", "DALI_USE_VMM"},
+    };
+    // Settings that Triton passes to every backend
+    const char* const kServerKeys[] = {"backend-directory", "min-compute-capability",
+                                       "auto-complete-config", "default-max-batch-size"};
+    for (auto& key : keys) {
+      std::string value;
+      TRITON_CALL_GUARD(cmdline.MemberAsString(key.c_str(), &value));
+      if (key == "preallocate_device_mb") {
+        init_options.preallocate_device_bytes = static_cast<size_t>(ParseMB(key, value, 0));
+      } else if (key == "preallocate_pinned_mb") {
+        init_options.preallocate_pinned_bytes = static_cast<size_t>(ParseMB(key, value, 0));
+      } else if (key == "pool_max_cached_mb") {
+        pool_max_cached_bytes = ParseMB(key, value, -1);
+      } else if (dali_env.count(key)) {
+        init_options.env.emplace_back(dali_env.at(key), from_string<bool>(value) ? "1" : "0");
+      } else if (std::none_of(std::begin(kServerKeys), std::end(kServerKeys),
+                              [&](const char* k) { return key == k; })) {
+        LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                    make_string("Unknown DALI backend setting ", key, " is ignored.").c_str());
+      }
+    }
+  }
+
+  /**
+   * @brief Parse a setting of the \p key given in MiB and return it in bytes.
+   * @param min_value Lowest value accepted, e.g. -1 for the settings where it means no limit.
+   */
+  static int64_t ParseMB(const std::string& key, const std::string& value, int64_t min_value) {
+    constexpr int64_t kMaxMB = std::numeric_limits<int64_t>::max() >> 20;
+    int64_t mb = from_string<int64_t>(value);
+    ENFORCE(min_value <= mb && mb <= kMaxMB,
+            make_string("Invalid value of the backend setting ", key, ": ", value,
+                        ". Expected a number of MiB, at least ", min_value, "."));
+    return mb < 0 ? mb : mb << 20;
+  }
+
+  /**
+   * @brief Apply the settings. Has to be called before the first pipeline is created.
+   */
+  void Apply() const {
+    DaliPipeline::SetInitOptions(init_options);
+    if (pool_max_cached_bytes >= 0) {
+      MemoryPool::SetDefaultMaxCachedBytes(pool_max_cached_bytes);
+    }
+  }
+
+  std::string ToString() const {
+    std::stringstream ss;
+    ss << "preallocate_device_bytes=" << init_options.preallocate_device_bytes
+       << " preallocate_pinned_bytes=" << init_options.preallocate_pinned_bytes
+       << " pool_max_cached_bytes=" << pool_max_cached_bytes;
+    for (auto& var : init_options.env) {
+      ss << " " << var.first << "=" << var.second;
+    }
+    return ss.str();
+  }
+};
+
+/**
+ * Stages of processing a batch of requests, timed separately.
+ */
+enum ProcessingStage {
+  kGatherInputs = 0,
+  kInputCopy,
+  kPipelineRun,
+  kOutputShape,
+  kOutputAlloc,
+  kOutputCopy,
+};
+
+const std::vector<std::string> kProcessingStageNames = {
+    "gather_inputs", "input_copy", "pipeline_run", "output_shape", "output_alloc", "output_copy"};
+
+/**
+ * Kinds of the memory reported in the metrics of each instance, with the memory_stats parameter.
+ * The staging buffers come from the pools shared by the instances on a device.
+ */
+const char* const kMemoryGaugeKinds[] = {"pipeline_used", "pipeline_reserved", "host_staging",
+                                         "device_staging"};
+
+/**
+ * Number of the batches, the memory of which is observed, before the requests predicted to exceed
+ * the memory_budget are rejected. Until then, they are only run in parts.
+ */
+const size_t kMinMemoryEstimateBatches = 8;
+
 struct ProcessingMeta {
   TimeInterval compute_interval{};
   int total_batch_size = 0;
+  bool async = false;  // outputs are copied and the responses are sent in the background
 };
 
 struct InputsInfo {
@@ -174,42 +1228,165 @@ class DaliModelInstance : public ::triton::backend::BackendModelInstance {
                                     TRITONBACKEND_ModelInstance* triton_model_instance,
                                     DaliModelInstance** state);
 
-  DaliExecutor& GetDaliExecutor() {
-    return *dali_executor_;
+  /**
+   * @brief Get the executor of the instance, nullptr if it hasn't been needed yet.
+   *
+   * With the sequence batcher, it's created only for requests outside of any sequence.
+   */
+  DaliExecutor* GetDaliExecutor() {
+    return dali_executor_;
+  }
+
+  const DaliModel& GetDaliModel() const {
+    return *dali_model_;
+  }
+
+  ~DaliModelInstance() {
+    // The executor might be shared and outlive the instance,
+    // so the outputs sent in the background have to be completed here.
+    if (!shared_executor_)
+      return;
+    std::lock_guard<std::mutex> lock(shared_executor_->mutex);
+    dali_executor_->WaitForAsyncOutputs();
+  }
+
+  void Execute(std::vector<TritonRequest> requests) {
+    TRITON_DALI_RANGE(range,
+                      make_string("Execute ", dali_model_->Name(), " ", Name(), " requests=",
+                                  requests.size()),
+                      TimeRange::kRed);
+    DeviceGuard dg(GetDaliDeviceId());
+    TimeInterval exec_interval{};
+    start_timer_ns(exec_interval);
+    auto responses = CreateResponses(requests);
+    ProcessingMeta proc_meta{};
+    TritonError error{};
+    try {
+      BindExecuteThread();
+      proc_meta = ProcessRequests(requests, responses, exec_interval);
+    } catch (...) { error = ErrorHandler(); }
+    if (proc_meta.async && !error) {
+      return;  // requests and responses are owned by the background copy now
+    }
+    CompleteRequests(requests, responses, proc_meta, exec_interval, error);
+  }
+
+ private:
+  /**
+   * @brief Pipeline of a sequence of requests, with the sequence batcher.
+   */
+  struct SequenceState {
+    std::unique_ptr<SharedExecutor> executor;
+    int64_t last_used_ns = 0;
+  };
+
+  /**
+   * @brief Bind the thread calling Execute to the instance's CPUs, the first time it's called.
+   *
+   * Host staging buffers are first touched by this thread, so they land on its NUMA node.
+   */
+  void BindExecuteThread() {
+    if (execute_thread_bound_)
+      return;
+    execute_thread_bound_ = true;
+    if (!SetThreadAffinity(cpu_affinity_)) {
+      LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                  make_string("Failed to bind the execution thread of ", Name(),
+                              " to its CPUs. The thread is not bound.")
+                      .c_str());
+    }
   }
 
-  const DaliModel& GetDaliModel() const {
-    return *dali_model_;
+  DaliModelInstance(DaliModel* model, TRITONBACKEND_ModelInstance* triton_model_instance) :
+      BackendModelInstance(model, triton_model_instance),
+      dali_model_(model),
+      latencies_(kProcessingStageNames) {
+    auto& params = dali_model_->GetModelParamters();
+    cpu_affinity_ = DaliModel::ResolveCpuAffinity(params.GetCpuAffinity(), GetDaliDeviceId());
+    SetupBindings();
+    sequence_batching_ = dali_model_->IsSequenceModel();
+    output_cache_ = dali_model_->GetOutputCache();
+    bool gpu_inputs = std::any_of(input_devices_.begin(), input_devices_.end(),
+                                  [](device_type_t dev) { return dev == device_type_t::GPU; });
+    if (output_cache_ && (gpu_inputs || sequence_batching_)) {
+      LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                  make_string("Response cache is disabled for ", Name(), ", because ",
+                              gpu_inputs ? "some of the inputs are consumed on the GPU."
+                                         : "the outputs depend on the state of the sequence.")
+                      .c_str());
+      output_cache_ = nullptr;
+    }
+    if (sequence_batching_) {
+      sequence_idle_timeout_ns_ = dali_model_->GetSequenceIdleTimeoutNs();
+      ready_sequence_pipelines_ = params.GetReadySequencePipelines();
+      PrepareSequenceExecutors();
+    } else {
+      AcquireSharedExecutor();
+    }
+    latency_log_interval_ns_ = static_cast<int64_t>(params.GetLatencyLogInterval()) * 1000000000;
+    last_latency_log_ns_ = capture_time();
+    memory_stats_ = params.GetMemoryStats();
+    memory_budget_ = static_cast<size_t>(params.GetMemoryBudget());
+    bucket_size_ratio_ = params.GetBucketSizeRatio();
+    if (memory_stats_)
+      CreateMemoryGauges();
   }
 
-  void Execute(const std::vector<TritonRequest>& requests) {
-    DeviceGuard dg(GetDaliDeviceId());
-    TimeInterval exec_interval{};
-    start_timer_ns(exec_interval);
-    auto responses = CreateResponses(requests);
-    ProcessingMeta proc_meta{};
-    TritonError error{};
-    try {
-      proc_meta = ProcessRequests(requests, responses);
-    } catch (...) { error = ErrorHandler(); }
+  /**
+   * @brief Send the responses and report the statistics of processed requests.
+   */
+  void CompleteRequests(std::vector<TritonRequest>& requests,
+                        std::vector<TritonResponse>& responses, const ProcessingMeta& proc_meta,
+                        TimeInterval exec_interval, const TritonError& error) {
+    TRITON_DALI_RANGE(range,
+                      make_string("SendResponses ", Name(), " requests=", responses.size()),
+                      TimeRange::kMagenta);
     for (auto& response : responses) {
-      SendResponse(std::move(response), TritonError::Copy(error));
+      if (response)  // not sent early
+        SendResponse(std::move(response), TritonError::Copy(error));
     }
     end_timer_ns(exec_interval);
     for (auto& request : requests) {
       ReportStats(request, exec_interval, proc_meta.compute_interval, !error);
     }
-    ReportBatchStats(proc_meta.total_batch_size, exec_interval, proc_meta.compute_interval);
+    if (!requests.empty())
+      ReportBatchStats(proc_meta.total_batch_size, exec_interval, proc_meta.compute_interval);
+    LogLatencies();
   }
 
- private:
-  DaliModelInstance(DaliModel* model, TRITONBACKEND_ModelInstance* triton_model_instance) :
-      BackendModelInstance(model, triton_model_instance), dali_model_(model) {
-    auto serialized_pipeline = dali_model_->GetModelProvider().GetModel();
-    auto max_batch_size = dali_model_->MaxBatchSize();
-    auto num_threads = dali_model_->GetModelParamters().GetNumThreads();
-    DaliPipeline pipeline(serialized_pipeline, max_batch_size, num_threads, GetDaliDeviceId());
-    dali_executor_ = std::make_unique<DaliExecutor>(std::move(pipeline));
+  /**
+   * @brief Log the latency histograms, if the configured interval passed since the last time.
+   */
+  void LogLatencies() {
+    if (latency_log_interval_ns_ <= 0)
+      return;
+    auto now = capture_time();
+    auto last = last_latency_log_ns_.load();
+    if (now - last < latency_log_interval_ns_ ||
+        !last_latency_log_ns_.compare_exchange_strong(last, now))
+      return;
+    LOG_MESSAGE(TRITONSERVER_LOG_INFO,
+                make_string("Latency of ", Name(), " stages (us): ", latencies_.Summary()).c_str());
+    if (memory_stats_) {
+      ExecutorMemoryStats stats;
+      {
+        std::lock_guard<std::mutex> lock(memory_stats_mutex_);
+        stats = last_memory_stats_;
+      }
+      LOG_MESSAGE(TRITONSERVER_LOG_INFO,
+                  make_string("Memory of ", Name(), " (bytes): pipeline used ",
+                              stats.pipeline.used_bytes, " (peak ", stats.pipeline.peak_used_bytes,
+                              "), reserved ", stats.pipeline.reserved_bytes, " (peak ",
+                              stats.pipeline.peak_reserved_bytes, "), staging host ",
+                              stats.host.used_bytes + stats.host.cached_bytes, ", device ",
+                              stats.device.used_bytes + stats.device.cached_bytes)
+                      .c_str());
+    }
+    if (output_cache_) {
+      LOG_MESSAGE(TRITONSERVER_LOG_INFO,
+                  make_string("Response cache hit rate of ", dali_model_->Name(), ": ",
+                              output_cache_->GetStats().HitRate() * 100, "%").c_str());
+    }
   }
 
   void ReportStats(TritonRequestView request, TimeInterval exec, TimeInterval compute,
@@ -243,83 +1420,872 @@ class DaliModelInstance : public ::triton::backend::BackendModelInstance {
 
   /**
    * @brief Run inference for a given \p request and prepare a response.
+   *
+   * Invalid requests, and requests with the outputs in the cache, are answered right away
+   * and removed from \p requests and \p responses, so that the pipeline runs only for the rest.
+   * If the pipeline fails on a batch of several requests, each of them is retried alone,
+   * so that only the requests failing on their own get an error.
+   * With the bucket_size_ratio parameter, requests with samples of very different sizes
+   * are run in separate parts. So is a batch predicted to exceed the memory_budget.
+   * Requests of a model with the sequence batcher run one by one, on the pipelines
+   * of their sequences.
+   * @return computation time interval and total batch size
+   */
+  ProcessingMeta ProcessRequests(std::vector<TritonRequest>& requests,
+                                 std::vector<TritonResponse>& responses,
+                                 TimeInterval exec_interval) {
+    RejectInvalidRequests(requests, responses, exec_interval);
+    if (output_cache_)
+      ServeCachedRequests(requests, responses, exec_interval);
+    if (requests.empty())
+      return {};
+    if (sequence_batching_) {
+      RunSequenceRequests(requests, responses, exec_interval);
+      return {};
+    }
+    std::vector<size_t> part_ends = {requests.size()};
+    if (bucket_size_ratio_ > 0 && requests.size() > 1)
+      part_ends = BucketBySampleSize(requests, responses);
+    if (memory_budget_ > 0)
+      part_ends = SplitByMemoryBudget(requests, part_ends);
+    if (part_ends.size() > 1) {
+      LOG_MESSAGE(TRITONSERVER_LOG_VERBOSE,
+                  make_string("Batch of ", requests.size(), " requests in ", Name(), " is run in ",
+                              part_ends.size(), " parts.")
+                      .c_str());
+      RunInParts(requests, responses, part_ends, exec_interval);
+      return {};
+    }
+    return RunOrRetryEach(requests, responses, exec_interval, true);
+  }
+
+  /**
+   * @brief Run the pipeline for the \p requests as one batch. If it fails on several requests,
+   *        retry each of them alone.
+   *
+   * The retried requests are completed and removed from \p requests and \p responses.
+   * @return computation time interval and total batch size
+   */
+  ProcessingMeta RunOrRetryEach(std::vector<TritonRequest>& requests,
+                                std::vector<TritonResponse>& responses,
+                                TimeInterval exec_interval, bool allow_async) {
+    bool run_failed = false;
+    try {
+      return RunRequests(*shared_executor_, requests, responses, exec_interval, allow_async,
+                         run_failed);
+    } catch (...) {
+      if (!run_failed || requests.size() < 2)
+        throw;
+      ErrorHandler();
+    }
+    LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                make_string("Retrying the ", requests.size(), " requests of the failed batch in ",
+                            Name(), " one by one.")
+                    .c_str());
+    RetryEachRequest(requests, responses, exec_interval);
+    return {};
+  }
+
+  /**
+   * @brief Run the pipeline of the \p shared executor for the \p requests and send the responses.
+   *
+   * Each response is sent as soon as the outputs of its request are copied.
+   * If the executor is asynchronous and \p allow_async is set, the outputs are copied
+   * in the background and the \p requests and \p responses are taken over
+   * to be completed when the copy is finished.
+   * @param[out] run_failed Set, if the pipeline run failed.
    * @return computation time interval and total batch size
    */
-  ProcessingMeta ProcessRequests(const std::vector<TritonRequest>& requests,
-                                 const std::vector<TritonResponse>& responses) {
+  ProcessingMeta RunRequests(SharedExecutor& shared, std::vector<TritonRequest>& requests,
+                             std::vector<TritonResponse>& responses, TimeInterval exec_interval,
+                             bool allow_async, bool& run_failed) {
     ProcessingMeta ret{};
-    auto inputs_info = GenerateInputs(requests);
+    TimeInterval stage_interval{};
+    start_timer_ns(stage_interval);
+    const auto& inputs_info = GenerateInputs(requests);
+    end_timer_ns(stage_interval);
+    latencies_.Record(kGatherInputs, duration_ns(stage_interval));
+    // Held until the outputs are copied or scheduled, the executor might be shared
+    std::lock_guard<std::mutex> executor_lock(shared.mutex);
+    auto& executor = *shared.executor;
     start_timer_ns(ret.compute_interval);
-    auto outputs_info = dali_executor_->Run(inputs_info.inputs);
+    const std::vector<OutputInfo>* outputs_info = nullptr;
+    try {
+      outputs_info = &executor.Run(inputs_info.inputs);
+    } catch (...) {
+      run_failed = true;
+      throw;
+    }
     end_timer_ns(ret.compute_interval);
+    if (memory_stats_)
+      RecordMemoryStats(executor, inputs_info.inputs);
+    auto& run_timings = executor.LastRunTimings();
+    latencies_.Record(kInputCopy, run_timings.input_copy_ns);
+    latencies_.Record(kPipelineRun, run_timings.run_ns);
+    latencies_.Record(kOutputShape, run_timings.output_shape_ns);
     for (auto& bs : inputs_info.reqs_batch_sizes) {
       ret.total_batch_size += bs;
     }
-    auto dali_outputs =
-        AllocateOutputs(requests, responses, inputs_info.reqs_batch_sizes, outputs_info);
-    dali_executor_->PutOutputs(dali_outputs);
+    start_timer_ns(stage_interval);
+    const auto& dali_outputs =
+        AllocateOutputs(requests, responses, inputs_info.reqs_batch_sizes, *outputs_info);
+    end_timer_ns(stage_interval);
+    latencies_.Record(kOutputAlloc, duration_ns(stage_interval));
+    start_timer_ns(stage_interval);
+    if (allow_async && executor.IsAsync()) {
+      ret.async = true;
+      auto reqs = std::make_shared<std::vector<TritonRequest>>(std::move(requests));
+      auto resps = std::make_shared<std::vector<TritonResponse>>(std::move(responses));
+      // The scratch structures are reused by the next batch, the callbacks need copies
+      std::vector<ODescr> cached_outputs;
+      std::vector<int> batch_sizes;
+      std::vector<std::shared_ptr<const OutputCache::Key>> keys;
+      if (output_cache_) {
+        cached_outputs = dali_outputs;
+        batch_sizes = inputs_info.reqs_batch_sizes;
+        keys = request_keys_;
+      }
+      executor.PutOutputsAsync(
+          dali_outputs,
+          [this, reqs, resps, ret, exec_interval, stage_interval](std::exception_ptr e) {
+            auto copy_interval = stage_interval;
+            end_timer_ns(copy_interval);
+            latencies_.Record(kOutputCopy, duration_ns(copy_interval));
+            TritonError error{};
+            if (e) {
+              try {
+                std::rethrow_exception(e);
+              } catch (...) { error = ErrorHandler(); }
+            }
+            CompleteRequests(*reqs, *resps, ret, exec_interval, error);
+          },
+          [this, resps, cached_outputs, batch_sizes, keys](int request_idx) {
+            SendCopiedResponse(request_idx, *resps, cached_outputs, batch_sizes, keys);
+          });
+    } else {
+      executor.PutOutputs(dali_outputs, [&](int request_idx) {
+        SendCopiedResponse(request_idx, responses, dali_outputs, inputs_info.reqs_batch_sizes,
+                           request_keys_);
+      });
+      end_timer_ns(stage_interval);
+      latencies_.Record(kOutputCopy, duration_ns(stage_interval));
+    }
     return ret;
   }
 
+  /**
+   * @brief Run each of the \p requests alone and complete it.
+   *
+   * The requests are removed from \p requests and \p responses.
+   */
+  void RetryEachRequest(std::vector<TritonRequest>& requests,
+                        std::vector<TritonResponse>& responses, TimeInterval exec_interval) {
+    std::vector<size_t> part_ends(requests.size());
+    std::iota(part_ends.begin(), part_ends.end(), 1);
+    RunInParts(requests, responses, part_ends, exec_interval);
+  }
+
+  /**
+   * @brief Run the \p requests in consecutive parts, one after another, and complete them.
+   *
+   * A failure of a part of several requests is retried for each of them alone, as for
+   * a whole batch. The outputs of the last part may be copied in the background.
+   * The requests are removed from \p requests and \p responses.
+   * @param part_ends Index of the request following each part.
+   */
+  void RunInParts(std::vector<TritonRequest>& requests, std::vector<TritonResponse>& responses,
+                  const std::vector<size_t>& part_ends, TimeInterval exec_interval) {
+    auto keys = std::move(request_keys_);
+    size_t begin = 0;
+    for (auto end : part_ends) {
+      std::vector<TritonRequest> part_requests;
+      std::vector<TritonResponse> part_responses;
+      request_keys_.clear();
+      for (size_t ri = begin; ri < end; ++ri) {
+        part_requests.push_back(std::move(requests[ri]));
+        part_responses.push_back(std::move(responses[ri]));
+        request_keys_.push_back(ri < keys.size() ? keys[ri] : nullptr);
+      }
+      begin = end;
+      ProcessingMeta proc_meta{};
+      TritonError error{};
+      try {
+        proc_meta = RunOrRetryEach(part_requests, part_responses, exec_interval,
+                                   end == part_ends.back());
+      } catch (...) { error = ErrorHandler(); }
+      if (proc_meta.async && !error)
+        continue;  // completed by the background copy
+      CompleteRequests(part_requests, part_responses, proc_meta, exec_interval, error);
+    }
+    requests.clear();
+    responses.clear();
+  }
+
+  /**
+   * @brief Split the parts of the \p requests further, so that each is predicted to fit
+   *        in the memory_budget.
+   *
+   * @param part_ends Index of the request following each part.
+   * @return Index of the request following each of the resulting parts.
+   */
+  std::vector<size_t> SplitByMemoryBudget(const std::vector<TritonRequest>& requests,
+                                          const std::vector<size_t>& part_ends) {
+    std::vector<size_t> split_ends;
+    size_t begin = 0;
+    for (auto end : part_ends) {
+      size_t part_bytes = 0;
+      for (size_t ri = begin; ri < end; ++ri) {
+        auto request_bytes = RequestInputBytes(requests[ri]);
+        if (ri > begin && PredictMemoryBytes(part_bytes + request_bytes) > memory_budget_) {
+          split_ends.push_back(ri);
+          part_bytes = 0;
+        }
+        part_bytes += request_bytes;
+      }
+      split_ends.push_back(end);
+      begin = end;
+    }
+    return split_ends;
+  }
+
+  /**
+   * @brief Sort the \p requests and their \p responses by the size of their samples
+   *        and group them in parts, in which the sizes differ at most bucket_size_ratio times.
+   *
+   * Each part then runs as a separate batch, so that the operators get samples with similar
+   * amounts of work and the outputs are not sized for the largest samples of the whole batch.
+   * @return Index of the request following each part.
+   */
+  std::vector<size_t> BucketBySampleSize(std::vector<TritonRequest>& requests,
+                                         std::vector<TritonResponse>& responses) {
+    std::vector<size_t> sample_bytes(requests.size());
+    for (size_t ri = 0; ri < requests.size(); ++ri) {
+      int64_t batch_size = requests[ri].InputCount() > 0 ? requests[ri].InputByIdx(0).BatchSize()
+                                                         : 1;
+      sample_bytes[ri] = RequestInputBytes(requests[ri]) / std::max<int64_t>(batch_size, 1);
+    }
+    auto part_ends = bucket_by_size(sample_bytes, bucket_size_ratio_, request_order_);
+    permute(requests, request_order_);
+    permute(responses, request_order_);
+    if (output_cache_)
+      permute(request_keys_, request_order_);
+    return part_ends;
+  }
+
+  /**
+   * @brief Get the total size of the inputs of a \p request.
+   */
+  size_t RequestInputBytes(const TritonRequest& request) {
+    size_t bytes = 0;
+    for (uint32_t input_idx = 0; input_idx < request.InputCount(); ++input_idx) {
+      bytes += request.InputByIdx(input_idx).ByteSize();
+    }
+    return bytes;
+  }
+
+  /**
+   * @brief Predict the memory needed to process inputs of a given size: the staging buffers
+   *        and the outputs of the operators, fitted to the recent batches as a fixed part
+   *        (e.g. outputs of a fixed size, the prefetch queue) and a part per input byte.
+   */
+  size_t PredictMemoryBytes(size_t input_bytes) const {
+    return input_bytes + static_cast<size_t>(memory_estimate_.Predict(input_bytes));
+  }
+
+  /**
+   * @brief Record the memory statistics of the \p executor after a run of given \p inputs.
+   *
+   * Updates the memory predicted for the next batches and the gauges of the instance.
+   */
+  void RecordMemoryStats(DaliExecutor& executor, const std::vector<IDescr>& inputs) {
+    auto stats = executor.GetMemoryStats();
+    size_t input_bytes = 0;
+    for (auto& input : inputs) {
+      for (auto& buffer : input.buffers) {
+        input_bytes += buffer.size;
+      }
+    }
+    if (input_bytes > 0)
+      memory_estimate_.Add(input_bytes, stats.pipeline.used_bytes);
+    if (!memory_gauges_.empty()) {
+      memory_gauges_[0].Set(stats.pipeline.used_bytes);
+      memory_gauges_[1].Set(stats.pipeline.reserved_bytes);
+      memory_gauges_[2].Set(stats.host.used_bytes + stats.host.cached_bytes);
+      memory_gauges_[3].Set(stats.device.used_bytes + stats.device.cached_bytes);
+    }
+    std::lock_guard<std::mutex> lock(memory_stats_mutex_);
+    last_memory_stats_ = stats;
+  }
+
+  /**
+   * @brief Create the gauges of the memory of the instance, if the server has the metrics.
+   *
+   * The gauges follow the order of kMemoryGaugeKinds.
+   */
+  void CreateMemoryGauges() {
+    TRITONBACKEND_Backend* backend;
+    TRITON_CALL_GUARD(TRITONBACKEND_ModelBackend(dali_model_->TritonModel(), &backend));
+    void* vstate;
+    TRITON_CALL_GUARD(TRITONBACKEND_BackendState(backend, &vstate));
+    auto& family = reinterpret_cast<DaliBackendState*>(vstate)->memory_gauges;
+    if (!family)
+      return;
+    for (auto kind : kMemoryGaugeKinds) {
+      memory_gauges_.push_back(TritonGauge::New(
+          family, {{"model", dali_model_->Name()}, {"instance", Name()}, {"kind", kind}}));
+    }
+  }
+
+  /**
+   * @brief Run each of the \p requests on the pipeline of its sequence and complete it.
+   *
+   * A sequence gets a fresh pipeline with its first request (or the first one seen by this
+   * instance), keeps it for the following ones and releases it with the last one, or when
+   * it's idle for longer than Triton keeps it. When the pipeline fails, it's released too,
+   * so the next request of the sequence starts over with a fresh one.
+   * The requests are removed from \p requests and \p responses.
+   */
+  void RunSequenceRequests(std::vector<TritonRequest>& requests,
+                           std::vector<TritonResponse>& responses, TimeInterval exec_interval) {
+    // Requests without a sequence (correlation ID 0), e.g. the null requests filling a slot
+    // of the sequence batcher, run on a shared pipeline of their own.
+    auto now = capture_time();
+    ReleaseIdleSequences(now);
+    for (size_t ri = 0; ri < requests.size(); ++ri) {
+      std::vector<TritonRequest> request;
+      std::vector<TritonResponse> response;
+      request.push_back(std::move(requests[ri]));
+      response.push_back(std::move(responses[ri]));
+      ProcessingMeta proc_meta{};
+      TritonError error{};
+      bool run_failed = false;
+      uint64_t id = 0;
+      bool end = false;
+      try {
+        id = request[0].CorrelationId();
+        if (id == 0) {
+          if (!shared_executor_)
+            AcquireSharedExecutor();
+          proc_meta =
+              RunRequests(*shared_executor_, request, response, exec_interval, false, run_failed);
+        } else {
+          auto flags = request[0].Flags();
+          bool starts = (flags & TRITONSERVER_REQUEST_FLAG_SEQUENCE_START) != 0;
+          end = (flags & TRITONSERVER_REQUEST_FLAG_SEQUENCE_END) != 0;
+          auto& sequence = AcquireSequence(id, starts);
+          sequence.last_used_ns = now;
+          proc_meta =
+              RunRequests(*sequence.executor, request, response, exec_interval, false, run_failed);
+        }
+      } catch (...) { error = ErrorHandler(); }
+      if (id != 0 && (end || run_failed))
+        sequences_.erase(id);
+      CompleteRequests(request, response, proc_meta, exec_interval, error);
+    }
+    requests.clear();
+    responses.clear();
+  }
+
+  /**
+   * @brief Get the executor of the instance from the model, shared by the instances on a device
+   *        with the share_pipeline parameter.
+   */
+  void AcquireSharedExecutor() {
+    shared_executor_ = dali_model_->AcquireExecutor(GetDaliDeviceId());
+    dali_executor_ = shared_executor_->executor.get();
+  }
+
+  /**
+   * @brief Check if the input with a given \p name is a control input of the sequence batcher.
+   */
+  bool IsControlInput(const char* name) const {
+    const auto& controls = dali_model_->GetControlInputs();
+    return std::any_of(controls.begin(), controls.end(),
+                       [&](const std::string& control) { return control == name; });
+  }
+
+  /**
+   * @brief Get the number of the inputs of the \p request, other than the control inputs.
+   */
+  uint32_t ModelInputCount(const TritonRequest& request) const {
+    if (dali_model_->GetControlInputs().empty())
+      return request.InputCount();
+    uint32_t count = 0;
+    for (uint32_t input_idx = 0; input_idx < request.InputCount(); ++input_idx) {
+      if (!IsControlInput(request.InputByIdx(input_idx).Name()))
+        count++;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Get the pipeline of a sequence with a given \p id.
+   *
+   * A sequence that's not running yet, or one that \p starts again, gets a fresh pipeline.
+   */
+  SequenceState& AcquireSequence(uint64_t id, bool starts) {
+    auto it = sequences_.find(id);
+    if (it != sequences_.end() && !starts)
+      return it->second;
+    auto executor = TakeSequenceExecutor();
+    auto& sequence = sequences_[id];
+    sequence.executor = std::make_unique<SharedExecutor>(std::move(executor));
+    return sequence;
+  }
+
+  /**
+   * @brief Release the pipelines of the sequences, that Triton has already dropped as idle.
+   */
+  void ReleaseIdleSequences(int64_t now) {
+    for (auto it = sequences_.begin(); it != sequences_.end();) {
+      if (now - it->second.last_used_ns > sequence_idle_timeout_ns_)
+        it = sequences_.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  /**
+   * @brief Get an executor for a new sequence, prepared in the background if possible.
+   */
+  std::unique_ptr<DaliExecutor> TakeSequenceExecutor() {
+    if (ready_sequence_executors_.empty())
+      return dali_model_->CreateSequenceExecutor(GetDaliDeviceId());
+    auto ready = std::move(ready_sequence_executors_.front());
+    ready_sequence_executors_.pop_front();
+    PrepareSequenceExecutors();
+    return ready.get();
+  }
+
+  /**
+   * @brief Start building the executors for the next sequences in the background,
+   *        up to the ready_sequence_pipelines parameter.
+   */
+  void PrepareSequenceExecutors() {
+    while (static_cast<int>(ready_sequence_executors_.size()) < ready_sequence_pipelines_) {
+      ready_sequence_executors_.push_back(
+          std::async(std::launch::async, [model = dali_model_, device_id = GetDaliDeviceId()]() {
+            return model->CreateSequenceExecutor(device_id);
+          }));
+    }
+  }
+
+  /**
+   * @brief Answer the requests failing ValidateRequest with an error and remove them
+   *        from \p requests and \p responses.
+   */
+  void RejectInvalidRequests(std::vector<TritonRequest>& requests,
+                             std::vector<TritonResponse>& responses, TimeInterval exec_interval) {
+    size_t kept = 0;
+    for (size_t ri = 0; ri < requests.size(); ++ri) {
+      TimeInterval check_interval{};
+      start_timer_ns(check_interval);
+      TritonError error{};
+      try {
+        ValidateRequest(requests[ri]);
+      } catch (...) { error = ErrorHandler(); }
+      if (!error) {
+        if (kept != ri) {
+          requests[kept] = std::move(requests[ri]);
+          responses[kept] = std::move(responses[ri]);
+        }
+        kept++;
+        continue;
+      }
+      end_timer_ns(check_interval);
+      SendResponse(std::move(responses[ri]), std::move(error));
+      auto request_exec_interval = exec_interval;
+      end_timer_ns(request_exec_interval);
+      ReportStats(requests[ri], request_exec_interval, check_interval, false);
+      TritonRequest rejected = std::move(requests[ri]);  // released here
+    }
+    requests.erase(requests.begin() + kept, requests.end());
+    responses.erase(responses.begin() + kept, responses.end());
+  }
+
+  /**
+   * @brief Check a request against the input bindings, before it's batched with others.
+   *
+   * Catches the problems, which would otherwise fail the whole batch: missing, repeated
+   * or unexpected inputs, mismatched types, shapes and sizes, malformed BYTES inputs and
+   * samples of image inputs that are not images, and requests predicted to exceed
+   * the memory_budget on their own.
+   * @throws DaliBackendException describing the problem.
+   */
+  void ValidateRequest(const TritonRequest& request) {
+    const auto& bindings = dali_model_->GetInputBindings();
+    ENFORCE(ModelInputCount(request) == bindings.size(),
+            make_string("Each request must provide all of the ", bindings.size(),
+                        " inputs of the model."));
+    checked_inputs_.assign(bindings.size(), false);
+    int64_t batch_size = -1;
+    size_t request_bytes = 0;
+    uint32_t model_input_idx = 0;
+    for (uint32_t input_idx = 0; input_idx < request.InputCount(); ++input_idx) {
+      auto input = request.InputByIdx(input_idx);
+      if (IsControlInput(input.Name()))
+        continue;
+      auto binding_idx = FindInput(input.Name(), model_input_idx++);
+      auto& binding = bindings[binding_idx];
+      ENFORCE(!checked_inputs_[binding_idx],
+              make_string("Input ", binding.name, " is given more than once."));
+      checked_inputs_[binding_idx] = true;
+      ENFORCE(input.Type() == binding.type,
+              make_string("Mismatched type for input ", binding.name, "."));
+      ENFORCE(batch_size < 0 || input.BatchSize() == batch_size,
+              "Each input in a request must have the same batch size.");
+      batch_size = input.BatchSize();
+      request_bytes += input.ByteSize();
+      auto sample_shape = input.SampleShape();
+      if (!binding.dims.empty()) {
+        bool match = sample_shape.size() == static_cast<int>(binding.dims.size());
+        for (int d = 0; match && d < sample_shape.size(); ++d) {
+          match = binding.dims[d] < 0 || binding.dims[d] == sample_shape[d];
+        }
+        ENFORCE(match, make_string("Shape of input ", binding.name,
+                                   " doesn't match the dims in the config."));
+      }
+      auto& checked = checked_input_;
+      checked.meta.name = binding.name;
+      checked.buffers.clear();
+      if (input.IsBytes()) {
+        ENFORCE(batch_size == 0 || volume(sample_shape) == 1,
+                make_string("Each sample of BYTES input ", binding.name,
+                            " has to be a single element."));
+        bytes_buffers_.clear();
+        for (uint32_t buffer_idx = 0; buffer_idx < input.BufferCount(); ++buffer_idx) {
+          bytes_buffers_.push_back(
+              input.GetBuffer(buffer_idx, device_type_t::CPU, GetDaliDeviceId()));
+        }
+        checked.meta.type = DALI_UINT8;
+        checked.meta.shape = UnpackBytes(bytes_buffers_, batch_size, checked.buffers);
+      } else {
+        auto expected_size = batch_size * volume(sample_shape) * dali_type_size(binding.type);
+        ENFORCE(input.ByteSize() == static_cast<size_t>(expected_size),
+                make_string("Size of input ", binding.name, " doesn't match its shape."));
+        if (!binding.is_image)
+          continue;
+        auto device = input_devices_[binding_idx];
+        for (uint32_t buffer_idx = 0; buffer_idx < input.BufferCount(); ++buffer_idx) {
+          checked.buffers.push_back(input.GetBuffer(buffer_idx, device, GetDaliDeviceId()));
+        }
+        checked.meta.type = binding.type;
+        checked.meta.shape.resize(0);
+        append_uniform(checked.meta.shape, batch_size, sample_shape);
+      }
+      if (binding.is_image)
+        CheckEncodedImages(checked);
+    }
+    if (memory_budget_ > 0 && memory_estimate_.Count() >= kMinMemoryEstimateBatches) {
+      auto predicted = PredictMemoryBytes(request_bytes);
+      ENFORCE(predicted <= memory_budget_,
+              make_string("The request would need about ", predicted,
+                          " bytes of memory, more than the memory_budget of ", memory_budget_,
+                          " bytes."));
+    }
+  }
+
+  /**
+   * @brief Answer the requests, whose outputs are in the cache, and remove them from
+   *        \p requests and \p responses.
+   *
+   * Keys of the remaining requests are stored in request_keys_. A hit is served only if
+   * the inputs of the request are the same as the ones stored in the cache.
+   */
+  void ServeCachedRequests(std::vector<TritonRequest>& requests,
+                           std::vector<TritonResponse>& responses, TimeInterval exec_interval) {
+    TRITON_DALI_RANGE(range, make_string("ServeCachedRequests ", Name()), TimeRange::kGreen);
+    request_keys_.clear();
+    size_t kept = 0;
+    for (size_t ri = 0; ri < requests.size(); ++ri) {
+      TimeInterval serve_interval{};
+      start_timer_ns(serve_interval);
+      uint64_t hash = 0;
+      try {
+        hash = RequestKey(requests[ri]);
+      } catch (...) {
+        // Not cached; a malformed request is reported when its inputs are gathered
+      }
+      std::shared_ptr<const OutputCache::Entry> entry;
+      std::shared_ptr<const OutputCache::Key> key;
+      if (hash != 0) {
+        entry = output_cache_->Find(hash, key_inputs_);
+        if (!entry)
+          key = OutputCache::MakeKey(hash, key_inputs_);
+      }
+      if (!entry) {
+        request_keys_.push_back(key);
+        if (kept != ri) {
+          requests[kept] = std::move(requests[ri]);
+          responses[kept] = std::move(responses[ri]);
+        }
+        kept++;
+        continue;
+      }
+      TritonError error{};
+      try {
+        PutCachedOutputs(*entry, requests[ri], responses[ri]);
+      } catch (...) { error = ErrorHandler(); }
+      end_timer_ns(serve_interval);
+      SendResponse(std::move(responses[ri]), TritonError::Copy(error));
+      auto request_exec_interval = exec_interval;
+      end_timer_ns(request_exec_interval);
+      ReportStats(requests[ri], request_exec_interval, serve_interval, !error);
+      TritonRequest served = std::move(requests[ri]);  // released here
+    }
+    requests.erase(requests.begin() + kept, requests.end());
+    responses.erase(responses.begin() + kept, responses.end());
+  }
+
+  /**
+   * @brief Get the hash of the \p request inputs, which are left in key_inputs_.
+   * @return 0, if the request cannot be cached.
+   */
+  uint64_t RequestKey(const TritonRequest& request) {
+    auto& inputs = key_inputs_;
+    inputs.resize(inputs_info_.inputs.size());
+    if (request.InputCount() != inputs.size())
+      return 0;
+    for (uint32_t input_idx = 0; input_idx < inputs.size(); ++input_idx) {
+      auto input = request.InputByIdx(input_idx);
+      auto& descr = inputs[FindInput(input.Name(), input_idx)];
+      descr.meta.name = input.Name();
+      descr.meta.type = input.Type();
+      descr.meta.shape.resize(0);
+      append_uniform(descr.meta.shape, input.BatchSize(), input.SampleShape());
+      descr.buffers.clear();
+      for (uint32_t buffer_idx = 0; buffer_idx < input.BufferCount(); ++buffer_idx) {
+        descr.buffers.push_back(
+            input.GetBuffer(buffer_idx, device_type_t::CPU, GetDaliDeviceId()));
+      }
+    }
+    return HashInputs(inputs);
+  }
+
+  /**
+   * @brief Create the outputs of the \p response and fill them with the cached \p entry.
+   */
+  void PutCachedOutputs(const OutputCache::Entry& entry, const TritonRequest& request,
+                        const TritonResponse& response) {
+    const auto& bindings = dali_model_->GetOutputBindings();
+    ENFORCE(request.OutputCount() == bindings.size(),
+            make_string("Number of outputs exptected by the request (", request.OutputCount(),
+                        ") does not match the number of outputs in the config (",
+                        bindings.size(), ")."));
+    for (const auto& binding : bindings) {
+      const auto& cached = entry[binding.output_idx];
+      array_shape(cached.shape, 0, cached.shape.num_samples(), output_shape_);
+      auto output = response.GetOutput(binding.name, cached.type, output_shape_);
+      auto buffer = output.AllocateBuffer(device_type_t::CPU, GetDaliDeviceId());
+      ENFORCE(cached.data.size() <= buffer.size,
+              make_string("Cached output ", binding.name, " does not fit the output buffer."));
+      CopySync(buffer.device, buffer.data, device_type_t::CPU, cached.data.data(),
+               cached.data.size());
+    }
+  }
+
+  /**
+   * @brief Send the response to a request, as soon as its outputs are copied.
+   *
+   * The outputs are stored in the cache first, as their buffers are released with the response.
+   * The sent response is left empty and skipped by CompleteRequests.
+   * @param batch_sizes batch size of each request
+   * @param keys key of each request in the cache, nullptr if it's not cached
+   */
+  void SendCopiedResponse(int request_idx, std::vector<TritonResponse>& responses,
+                          const std::vector<ODescr>& outputs, const std::vector<int>& batch_sizes,
+                          const std::vector<std::shared_ptr<const OutputCache::Key>>& keys) {
+    if (output_cache_ && keys[request_idx]) {
+      try {
+        CacheOutputs(outputs, batch_sizes, request_idx, keys[request_idx]);
+      } catch (...) {
+        ErrorHandler();  // the response is still valid
+      }
+    }
+    SendResponse(std::move(responses[request_idx]), TritonError{});
+  }
+
+  /**
+   * @brief Store the outputs copied to the response of a given request in the cache.
+   * @param batch_sizes batch size of each request
+   */
+  void CacheOutputs(const std::vector<ODescr>& outputs, const std::vector<int>& batch_sizes,
+                    int request_idx, std::shared_ptr<const OutputCache::Key> key) {
+    int64_t begin = 0;
+    for (int ri = 0; ri < request_idx; ++ri) {
+      begin += batch_sizes[ri];
+    }
+    int64_t end = begin + batch_sizes[request_idx];
+    OutputCache::Entry entry(outputs.size());
+    for (size_t out_idx = 0; out_idx < outputs.size(); ++out_idx) {
+      const auto& output = outputs[out_idx];
+      auto& cached = entry[out_idx];
+      cached.type = output.meta.type;
+      cached.shape = TensorListShape<>(end - begin, output.meta.shape.sample_dim());
+      for (int64_t sample_idx = begin; sample_idx < end; ++sample_idx) {
+        cached.shape.set_tensor_shape(sample_idx - begin,
+                                      output.meta.shape.tensor_shape_span(sample_idx));
+      }
+      cached.data.resize(cached.shape.num_elements() * dali_type_size(cached.type));
+      const auto& buffer = output.buffers[request_idx];
+      CopySync(device_type_t::CPU, cached.data.data(), buffer.device, buffer.data,
+               cached.data.size());
+    }
+    output_cache_->Insert(std::move(key), std::move(entry));
+  }
+
+  /**
+   * @brief Copy the data and wait for the copy to finish.
+   */
+  void CopySync(device_type_t dst_dev, void* dst, device_type_t src_dev, const void* src,
+                size_t size) {
+    if (dst_dev == device_type_t::CPU && src_dev == device_type_t::CPU) {
+      std::memcpy(dst, src, size);
+      return;
+    }
+    MemCopy(dst_dev, dst, src_dev, src, size, CudaStream());
+    CUDA_CALL_GUARD(cudaStreamSynchronize(CudaStream()));
+  }
+
   /**
    * @brief Generate descriptors of inputs provided by given \p requests
+   *
+   * The descriptors are kept in inputs_info_ and reused by subsequent batches, so that
+   * a batch of the same shape as one of the previous ones is gathered without allocations.
+   * The inputs are ordered as in the model's input bindings.
    * @return input descriptors and batch size of each request
    */
-  InputsInfo GenerateInputs(const std::vector<TritonRequest>& requests) {
-    uint32_t input_cnt = requests[0].InputCount();
-    std::vector<IDescr> inputs;
-    inputs.reserve(input_cnt);
-    std::unordered_map<std::string, IDescr> input_map;
-    std::vector<int> reqs_batch_sizes(requests.size());
+  const InputsInfo& GenerateInputs(const std::vector<TritonRequest>& requests) {
+    TRITON_DALI_RANGE(range, make_string("GenerateInputs ", Name()), TimeRange::kCyan);
+    auto& inputs = inputs_info_.inputs;
+    auto& reqs_batch_sizes = inputs_info_.reqs_batch_sizes;
+    uint32_t input_cnt = inputs.size();
+    for (auto& idescr : inputs) {
+      idescr.buffers.clear();
+      idescr.meta.shape.resize(0);
+    }
+    reqs_batch_sizes.resize(requests.size());
     for (size_t ri = 0; ri < requests.size(); ++ri) {
       auto& request = requests[ri];
-      ENFORCE(request.InputCount() == input_cnt,
-              "Each request must provide the same number of inputs.");
-      for (uint32_t input_idx = 0; input_idx < input_cnt; ++input_idx) {
+      ENFORCE(ModelInputCount(request) == input_cnt,
+              make_string("Each request must provide all of the ", input_cnt,
+                          " inputs of the model."));
+      uint32_t model_input_idx = 0;
+      for (uint32_t input_idx = 0; input_idx < request.InputCount(); ++input_idx) {
         auto input = request.InputByIdx(input_idx);
-        auto input_byte_size = input.ByteSize();
-        auto input_buffer_count = input.BufferCount();
-        auto meta = input.Meta();
-        auto& idescr = input_map[meta.name];
-        for (uint32_t buffer_idx = 0; buffer_idx < input_buffer_count; ++buffer_idx) {
-          auto buffer = input.GetBuffer(buffer_idx, device_type_t::CPU, GetDaliDeviceId());
-          idescr.buffers.push_back(buffer);
-        }
-        if (idescr.meta.shape.num_samples() == 0) {
-          idescr.meta = meta;
+        if (IsControlInput(input.Name()))
+          continue;
+        auto binding_idx = FindInput(input.Name(), model_input_idx);
+        auto& idescr = inputs[binding_idx];
+        ENFORCE(idescr.meta.type == input.Type(),
+                make_string("Mismatched type for input ", idescr.meta.name));
+        if (input.IsBytes()) {
+          GenerateBytesInput(input, idescr);
         } else {
-          ENFORCE(idescr.meta.type == meta.type,
-                  make_string("Mismatched type for input ", idescr.meta.name));
-          idescr.meta.shape.append(meta.shape);
+          auto device = input_devices_[binding_idx];
+          for (uint32_t buffer_idx = 0; buffer_idx < input.BufferCount(); ++buffer_idx) {
+            idescr.buffers.push_back(input.GetBuffer(buffer_idx, device, GetDaliDeviceId()));
+          }
+          append_uniform(idescr.meta.shape, input.BatchSize(), input.SampleShape());
         }
-        if (input_idx == 0) {
-          reqs_batch_sizes[ri] = meta.shape.num_samples();
+        if (model_input_idx++ == 0) {
+          reqs_batch_sizes[ri] = input.BatchSize();
         } else {
-          ENFORCE(meta.shape.num_samples() == reqs_batch_sizes[ri],
+          ENFORCE(input.BatchSize() == reqs_batch_sizes[ri],
                   "Each input in a request must have the same batch size.");
         }
       }
     }
-    for (const auto& descrs : input_map) {
-      inputs.push_back(descrs.second);
+    return inputs_info_;
+  }
+
+  /**
+   * @brief Get the position of the input with a given \p name in the input bindings.
+   * @param hint Position to check first, the requests usually list the inputs as the config.
+   */
+  size_t FindInput(const char* name, size_t hint) const {
+    const auto& bindings = dali_model_->GetInputBindings();
+    if (bindings[hint].name == name)
+      return hint;
+    for (size_t i = 0; i < bindings.size(); ++i) {
+      if (bindings[i].name == name)
+        return i;
+    }
+    throw DaliBackendException(make_string("Unexpected input ", name, "."));
+  }
+
+  /**
+   * @brief Unpack a BYTES input, so that each of its elements becomes a separate sample.
+   *
+   * Appends the shapes of the elements to \p idescr shape and their payloads
+   * to \p idescr buffers.
+   */
+  void GenerateBytesInput(TritonInput& input, IDescr& idescr) {
+    auto batch_size = input.BatchSize();
+    ENFORCE(batch_size == 0 || volume(input.SampleShape()) == 1,
+            make_string("Each sample of BYTES input ", idescr.meta.name,
+                        " has to be a single element."));
+    bytes_buffers_.clear();
+    for (uint32_t buffer_idx = 0; buffer_idx < input.BufferCount(); ++buffer_idx) {
+      bytes_buffers_.push_back(input.GetBuffer(buffer_idx, device_type_t::CPU, GetDaliDeviceId()));
+    }
+    auto shape = UnpackBytes(bytes_buffers_, batch_size, idescr.buffers);
+    auto& list_shape = idescr.meta.shape;
+    if (list_shape.num_samples() == 0) {
+      list_shape = std::move(shape);
+    } else {
+      for (int i = 0; i < shape.num_samples(); ++i) {
+        append_uniform(list_shape, 1, shape.tensor_shape_span(i));
+      }
     }
-    return {inputs, reqs_batch_sizes};
   }
 
   int32_t GetDaliDeviceId() {
     return !CudaStream() ? ::dali::CPU_ONLY_DEVICE_ID : device_id_;
   }
 
+  /**
+   * @brief Get the device, on which the input is requested from Triton.
+   *
+   * Inputs consumed on the GPU by the pipeline are requested in the device memory,
+   * unless the instance runs without a GPU.
+   */
+  device_type_t GetInputDevice(const InputBinding& binding) {
+    if (GetDaliDeviceId() == ::dali::CPU_ONLY_DEVICE_ID)
+      return device_type_t::CPU;
+    return binding.device;
+  }
+
+  /**
+   * @brief Prepare the descriptors of the inputs and outputs, reused by every batch.
+   */
+  void SetupBindings() {
+    const auto& input_bindings = dali_model_->GetInputBindings();
+    inputs_info_.inputs.resize(input_bindings.size());
+    input_devices_.resize(input_bindings.size());
+    for (size_t i = 0; i < input_bindings.size(); ++i) {
+      inputs_info_.inputs[i].meta.name = input_bindings[i].name;
+      inputs_info_.inputs[i].meta.type = input_bindings[i].type;
+      input_devices_[i] = GetInputDevice(input_bindings[i]);
+    }
+    const auto& output_bindings = dali_model_->GetOutputBindings();
+    outputs_.resize(output_bindings.size());
+    for (const auto& binding : output_bindings) {
+      outputs_[binding.output_idx].meta.name = binding.name;
+    }
+  }
+
   /**
    * @brief Allocate outputs expected by given \p requests.
    *
-   * Lifetime of the created buffer is bound to each of the \p responses
+   * Lifetime of the created buffer is bound to each of the \p responses.
+   * The descriptors are kept in outputs_ and reused by subsequent batches.
    * @param batch_sizes batch size of each request
    */
-  std::vector<ODescr> AllocateOutputs(const std::vector<TritonRequest>& requests,
-                                      const std::vector<TritonResponse>& responses,
-                                      const std::vector<int>& batch_sizes,
-                                      const std::vector<OutputInfo>& outputs_info) {
+  const std::vector<ODescr>& AllocateOutputs(const std::vector<TritonRequest>& requests,
+                                             const std::vector<TritonResponse>& responses,
+                                             const std::vector<int>& batch_sizes,
+                                             const std::vector<OutputInfo>& outputs_info) {
     assert(requests.size() > 0);
     assert(requests.size() == responses.size());
     assert(requests.size() == batch_sizes.size());
@@ -332,30 +2298,34 @@ class DaliModelInstance : public ::triton::backend::BackendModelInstance {
             make_string("Number of outputs expected by the requests (", output_cnt,
                         ") does not match the number of outputs from DALI pipeline (",
                         outputs_info.size(), ")."));
-    const auto& output_indices = dali_model_->GetOutputOrder();
-    ENFORCE(output_cnt == output_indices.size(),
+    const auto& output_bindings = dali_model_->GetOutputBindings();
+    ENFORCE(output_cnt == output_bindings.size(),
             make_string("Number of outputs exptected by the requests (", output_cnt,
                         ") does not match the number of outputs in the config (",
-                        output_indices.size(), ")."));
-    std::vector<ODescr> outputs(output_cnt);
-    outputs.reserve(output_cnt);
-    for (const auto& out_index : output_indices) {
-      auto name = out_index.first;
-      int output_idx = out_index.second;
-      auto shapes = split_list_shape(outputs_info[output_idx].shape, batch_sizes);
-      std::vector<OBufferDescr> buffers(requests.size());
-      IOMeta out_meta{};
-      out_meta.name = name;
-      out_meta.type = outputs_info[output_idx].type;
+                        output_bindings.size(), ")."));
+    int64_t total_batch_size = 0;
+    for (auto bs : batch_sizes) {
+      total_batch_size += bs;
+    }
+    for (const auto& binding : output_bindings) {
+      int output_idx = binding.output_idx;
+      const auto& info = outputs_info[output_idx];
+      ENFORCE(info.shape.num_samples() == total_batch_size,
+              make_string("Cannot split a shape list with ", info.shape.num_samples(),
+                          " samples to list shapes of total ", total_batch_size, " samples."));
+      auto& output = outputs_[output_idx];
+      output.meta.type = info.type;
+      output.meta.shape = info.shape;
+      output.buffers.resize(requests.size());
+      int64_t begin = 0;
       for (size_t ri = 0; ri < requests.size(); ++ri) {
-        out_meta.shape = shapes[ri];
-        auto output = responses[ri].GetOutput(out_meta);
-        buffers[ri] = output.AllocateBuffer(outputs_info[output_idx].device, GetDaliDeviceId());
+        array_shape(info.shape, begin, begin + batch_sizes[ri], output_shape_);
+        begin += batch_sizes[ri];
+        auto triton_output = responses[ri].GetOutput(output.meta.name, info.type, output_shape_);
+        output.buffers[ri] = triton_output.AllocateBuffer(info.device, GetDaliDeviceId());
       }
-      out_meta.shape = outputs_info[output_idx].shape;
-      outputs[output_idx] = {out_meta, buffers};
     }
-    return outputs;
+    return outputs_;
   }
 
   TritonError ErrorHandler() {
@@ -384,8 +2354,39 @@ class DaliModelInstance : public ::triton::backend::BackendModelInstance {
     return error;
   }
 
-  std::unique_ptr<DaliExecutor> dali_executor_;
+  // Scratch structures reused across batches, indexed by the input/output position
+  InputsInfo inputs_info_{};
+  std::vector<device_type_t> input_devices_{};  // indexed by the input binding
+  OutputCache* output_cache_ = nullptr;
+  std::vector<IDescr> key_inputs_{};
+  // key of each request in the batch, nullptr if not cached
+  std::vector<std::shared_ptr<const OutputCache::Key>> request_keys_{};
+  std::vector<size_t> request_order_{};
+  std::vector<IBufferDescr> bytes_buffers_{};
+  std::vector<bool> checked_inputs_{};  // indexed by the input binding
+  IDescr checked_input_{};
+  std::vector<ODescr> outputs_{};
+  std::vector<int64_t> output_shape_{};
+  std::vector<int> cpu_affinity_;
+  bool execute_thread_bound_ = false;
+  std::shared_ptr<SharedExecutor> shared_executor_;
+  DaliExecutor* dali_executor_ = nullptr;
+  bool sequence_batching_ = false;
+  int64_t sequence_idle_timeout_ns_ = 0;
+  int ready_sequence_pipelines_ = 0;
+  std::map<uint64_t, SequenceState> sequences_;  // by the correlation ID
+  std::deque<std::future<std::unique_ptr<DaliExecutor>>> ready_sequence_executors_;
   DaliModel* dali_model_;
+  StageLatencies latencies_;
+  int64_t latency_log_interval_ns_ = 0;
+  bool memory_stats_ = false;
+  size_t memory_budget_ = 0;          // 0 if not limited
+  size_t bucket_size_ratio_ = 0;      // 0 if the requests are not bucketed
+  LinearEstimate memory_estimate_{};  // pipeline memory by the size of the inputs
+  std::vector<TritonGauge> memory_gauges_{};
+  std::mutex memory_stats_mutex_;  // guards the stats logged from the background copies
+  ExecutorMemoryStats last_memory_stats_{};
+  std::atomic<int64_t> last_latency_log_ns_{0};
 };
 
 
@@ -447,9 +2448,8 @@ TRITONSERVER_Error* TRITONBACKEND_Initialize(TRITONBACKEND_Backend* backend) {
   }
 
 
-  // The backend configuration may contain information needed by the
-  // backend, such a command-line arguments. This backend doesn't use
-  // any such configuration but we print whatever is available.
+  // The backend configuration contains the command-line arguments
+  // given with --backend-config.
   TRITONSERVER_Message* backend_config_message;
   RETURN_IF_ERROR(TRITONBACKEND_BackendConfig(backend, &backend_config_message));
 
@@ -458,11 +2458,29 @@ TRITONSERVER_Error* TRITONBACKEND_Initialize(TRITONBACKEND_Backend* backend) {
   RETURN_IF_ERROR(TRITONSERVER_MessageSerializeToJson(backend_config_message, &buffer, &byte_size));
   LOG_MESSAGE(TRITONSERVER_LOG_INFO, (std::string("backend configuration:\n") + buffer).c_str());
 
-  // If we have any global backend state we create and set it here. We
-  // don't need anything for this backend but for demonstration
-  // purposes we just create something...
-  std::string* state = new std::string("backend state");
-  RETURN_IF_ERROR(TRITONBACKEND_BackendSetState(backend, reinterpret_cast<void*>(state)));
+  auto state = std::make_unique<DaliBackendState>();
+  try {
+    common::TritonJson::Value backend_config;
+    if (byte_size > 0) {
+      RETURN_IF_ERROR(backend_config.Parse(buffer, byte_size));
+      state->ParseConfig(backend_config);
+    }
+    state->Apply();
+  } catch (const std::exception& e) {
+    return TRITONSERVER_ErrorNew(TRITONSERVER_ERROR_INVALID_ARG,
+                                 make_string("Invalid DALI backend config: ", e.what()).c_str());
+  }
+  LOG_MESSAGE(TRITONSERVER_LOG_INFO,
+              (std::string("DALI backend settings: ") + state->ToString()).c_str());
+  try {
+    state->memory_gauges = TritonGaugeFamily::New(
+        "nv_dali_memory_bytes", "Memory of the DALI pipelines and of their staging buffers");
+  } catch (const std::exception& e) {
+    LOG_MESSAGE(TRITONSERVER_LOG_WARN,
+                make_string("DALI memory metrics are not available: ", e.what()).c_str());
+  }
+  RETURN_IF_ERROR(
+      TRITONBACKEND_BackendSetState(backend, reinterpret_cast<void*>(state.release())));
 
   return nullptr;  // success
 }
@@ -473,10 +2491,9 @@ TRITONSERVER_Error* TRITONBACKEND_Initialize(TRITONBACKEND_Backend* backend) {
 TRITONSERVER_Error* TRITONBACKEND_Finalize(TRITONBACKEND_Backend* backend) {
   void* vstate;
   RETURN_IF_ERROR(TRITONBACKEND_BackendState(backend, &vstate));
-  std::string* state = reinterpret_cast<std::string*>(vstate);
+  auto* state = reinterpret_cast<DaliBackendState*>(vstate);
 
-  LOG_MESSAGE(TRITONSERVER_LOG_INFO,
-              (std::string("TRITONBACKEND_Finalize: state is '") + *state + "'").c_str());
+  LOG_MESSAGE(TRITONSERVER_LOG_INFO, "TRITONBACKEND_Finalize: delete backend state");
 
   delete state;
 
@@ -508,18 +2525,6 @@ TRITONSERVER_Error* TRITONBACKEND_ModelInitialize(TRITONBACKEND_Model* model) {
   RETURN_IF_ERROR(TRITONBACKEND_ModelRepository(model, &artifact_type, &clocation));
   LOG_MESSAGE(TRITONSERVER_LOG_INFO, (std::string("Repository location: ") + clocation).c_str());
 
-  // The model can access the backend as well... here we can access
-  // the backend global state.
-  TRITONBACKEND_Backend* backend;
-  RETURN_IF_ERROR(TRITONBACKEND_ModelBackend(model, &backend));
-
-  void* vbackendstate;
-  RETURN_IF_ERROR(TRITONBACKEND_BackendState(backend, &vbackendstate));
-  std::string* backend_state = reinterpret_cast<std::string*>(vbackendstate);
-
-  LOG_MESSAGE(TRITONSERVER_LOG_INFO,
-              (std::string("backend state is '") + *backend_state + "'").c_str());
-
   // With each model we create a ModelState object and associate it
   // with the TRITONBACKEND_Model.
   DaliModel* model_state;
@@ -530,7 +2535,11 @@ TRITONSERVER_Error* TRITONBACKEND_ModelInitialize(TRITONBACKEND_Model* model) {
   // backend can support. If not, returning an error from this
   // function will prevent the model from loading.
   RETURN_IF_ERROR(model_state->ValidateModelConfig());
-  model_state->ReadOutputsOrder();
+  try {
+    model_state->PrebuildExecutors();
+  } catch (const std::exception& e) {
+    return TRITONSERVER_ErrorNew(TRITONSERVER_ERROR_INVALID_ARG, e.what());
+  }
 
   return nullptr;  // success
 }
@@ -545,6 +2554,16 @@ TRITONSERVER_Error* TRITONBACKEND_ModelFinalize(TRITONBACKEND_Model* model) {
 
   LOG_MESSAGE(TRITONSERVER_LOG_INFO, "TRITONBACKEND_ModelFinalize: delete model state");
 
+  if (auto cache = model_state->GetOutputCache()) {
+    auto stats = cache->GetStats();
+    LOG_MESSAGE(TRITONSERVER_LOG_INFO,
+                make_string("Response cache of ", model_state->Name(), ": ", stats.hits,
+                            " hits, ", stats.misses, " misses, hit rate ",
+                            stats.HitRate() * 100, "%, ", stats.entries, " entries, ",
+                            stats.bytes, " bytes")
+                    .c_str());
+  }
+
   delete model_state;
 
   return nullptr;  // success
@@ -597,6 +2616,16 @@ TRITONSERVER_Error* TRITONBACKEND_ModelInstanceFinalize(TRITONBACKEND_ModelInsta
 
   LOG_MESSAGE(TRITONSERVER_LOG_INFO, "TRITONBACKEND_ModelInstanceFinalize: delete instance state");
 
+  if (auto executor = instance_state->GetDaliExecutor()) {
+    auto mem_stats = executor->GetMemoryStats();
+    LOG_MESSAGE(TRITONSERVER_LOG_INFO,
+                make_string("Intermediate buffers pools usage (used/cached/peak bytes): host ",
+                            mem_stats.host.used_bytes, "/", mem_stats.host.cached_bytes, "/",
+                            mem_stats.host.peak_bytes, ", device ", mem_stats.device.used_bytes,
+                            "/", mem_stats.device.cached_bytes, "/", mem_stats.device.peak_bytes)
+                    .c_str());
+  }
+
   delete instance_state;
 
   return nullptr;  // success
@@ -615,7 +2644,7 @@ TRITONSERVER_Error* TRITONBACKEND_ModelInstanceExecute(TRITONBACKEND_ModelInstan
   std::vector<TRITONBACKEND_Response*> responses(request_count);
 
   try {
-    dali_instance->Execute(requests);
+    dali_instance->Execute(std::move(requests));
   } catch (TritonError& err) { return err.release(); }
 
   return nullptr;
@@ -0,0 +1,126 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "src/dali_executor/cpu_affinity.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "src/dali_executor/utils/dali.h"
+#include "src/error_handling.h"
+
+namespace triton { namespace backend { namespace dali {
+
+std::vector<int> ParseCpuList(const std::string &cpu_list) {
+  std::vector<int> cpus;
+  std::stringstream ss(cpu_list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+    if (range.empty())
+      continue;
+    auto dash = range.find('-');
+    try {
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      ENFORCE(0 <= first && first <= last, make_string("Invalid CPU range: ", range));
+      ENFORCE(last < CPU_SETSIZE,
+              make_string("CPU ", last, " is out of the supported range [0, ", CPU_SETSIZE, ")."));
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::logic_error &) {
+      throw DaliBackendException(make_string("Invalid CPU list: ", cpu_list));
+    }
+  }
+  return cpus;
+}
+
+std::vector<int> GetDeviceLocalCpus(int device_id) {
+  if (device_id < 0)
+    return {};
+  char bus_id[32];
+  if (cudaDeviceGetPCIBusId(bus_id, sizeof(bus_id), device_id) != cudaSuccess) {
+    cudaGetLastError();
+    return {};
+  }
+  std::string pci_address(bus_id);
+  std::transform(pci_address.begin(), pci_address.end(), pci_address.begin(), ::tolower);
+  std::ifstream cpulist("/sys/bus/pci/devices/" + pci_address + "/local_cpulist");
+  std::string content;
+  if (!cpulist || !std::getline(cpulist, content))
+    return {};
+  return ParseCpuList(content);
+}
+
+std::vector<int> GetAllowedCpus() {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0)
+    return {};
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set))
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+std::vector<int> IntersectCpus(const std::vector<int> &cpus, const std::vector<int> &allowed) {
+  std::vector<int> result;
+  std::copy_if(cpus.begin(), cpus.end(), std::back_inserter(result), [&](int cpu) {
+    return std::find(allowed.begin(), allowed.end(), cpu) != allowed.end();
+  });
+  return result;
+}
+
+bool SetThreadAffinity(const std::vector<int> &cpus) {
+  if (cpus.empty())
+    return true;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    ENFORCE(0 <= cpu && cpu < CPU_SETSIZE, make_string("Invalid CPU: ", cpu));
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+ScopedThreadAffinity::ScopedThreadAffinity(const std::vector<int> &cpus) {
+  if (cpus.empty())
+    return;
+  restore_ = pthread_getaffinity_np(pthread_self(), sizeof(saved_), &saved_) == 0;
+  succeeded_ = SetThreadAffinity(cpus);
+}
+
+ScopedThreadAffinity::~ScopedThreadAffinity() {
+  if (restore_) {
+    pthread_setaffinity_np(pthread_self(), sizeof(saved_), &saved_);
+  }
+}
+
+}}}  // namespace triton::backend::dali
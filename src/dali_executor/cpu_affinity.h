@@ -0,0 +1,92 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TRITONDALIBACKEND_CPU_AFFINITY_H
+#define TRITONDALIBACKEND_CPU_AFFINITY_H
+
+#include <sched.h>
+
+#include <string>
+#include <vector>
+
+namespace triton { namespace backend { namespace dali {
+
+/**
+ * @brief Parse a list of CPUs in the Linux cpulist format, e.g. "0-3,8,10-11".
+ *
+ * CPUs outside of [0, CPU_SETSIZE) can't be bound to and are rejected.
+ */
+std::vector<int> ParseCpuList(const std::string &cpu_list);
+
+/**
+ * @brief Get the CPUs of the NUMA node closest to a given device.
+ * @return Empty list, if the topology cannot be read.
+ */
+std::vector<int> GetDeviceLocalCpus(int device_id);
+
+/**
+ * @brief Get the CPUs the process is allowed to run on, e.g. within a container's cpuset.
+ * @return Empty list, if the affinity cannot be queried.
+ */
+std::vector<int> GetAllowedCpus();
+
+/**
+ * @brief Get the CPUs of \p cpus that are also in \p allowed, in the order of \p cpus.
+ */
+std::vector<int> IntersectCpus(const std::vector<int> &cpus, const std::vector<int> &allowed);
+
+/**
+ * @brief Bind the calling thread to the given CPUs. Empty list leaves the affinity as is.
+ * @return False, if the affinity couldn't be set, e.g. none of the CPUs is allowed.
+ */
+bool SetThreadAffinity(const std::vector<int> &cpus);
+
+/**
+ * @brief Bind the calling thread to the given CPUs for the lifetime of the object.
+ *
+ * Threads started meanwhile (e.g. DALI workers) inherit the affinity and keep it.
+ */
+class ScopedThreadAffinity {
+ public:
+  explicit ScopedThreadAffinity(const std::vector<int> &cpus);
+
+  ~ScopedThreadAffinity();
+
+  ScopedThreadAffinity(const ScopedThreadAffinity &) = delete;
+  ScopedThreadAffinity &operator=(const ScopedThreadAffinity &) = delete;
+
+  /**
+   * @brief False, if the affinity couldn't be set. The thread then runs unbound.
+   */
+  bool Succeeded() const {
+    return succeeded_;
+  }
+
+ private:
+  cpu_set_t saved_{};
+  bool restore_ = false;
+  bool succeeded_ = true;
+};
+
+}}}  // namespace triton::backend::dali
+
+#endif  // TRITONDALIBACKEND_CPU_AFFINITY_H
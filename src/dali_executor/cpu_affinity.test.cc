@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <pthread.h>
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include "src/dali_executor/cpu_affinity.h"
+#include "src/error_handling.h"
+
+namespace triton { namespace backend { namespace dali { namespace test {
+
+TEST_CASE("Parse CPU list") {
+  REQUIRE(ParseCpuList("").empty());
+  REQUIRE(ParseCpuList("3") == std::vector<int>{3});
+  REQUIRE(ParseCpuList("0-3,8, 10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+  REQUIRE_THROWS_AS(ParseCpuList("3-1"), DaliBackendException);
+  REQUIRE_THROWS_AS(ParseCpuList("a-b"), DaliBackendException);
+  REQUIRE_THROWS_AS(ParseCpuList("-1"), DaliBackendException);
+  REQUIRE_THROWS_AS(ParseCpuList(std::to_string(CPU_SETSIZE)), DaliBackendException);
+  REQUIRE_THROWS_AS(ParseCpuList("0-99999999"), DaliBackendException);
+  REQUIRE(ParseCpuList(std::to_string(CPU_SETSIZE - 1)) == std::vector<int>{CPU_SETSIZE - 1});
+}
+
+TEST_CASE("Intersect CPU lists") {
+  REQUIRE(IntersectCpus({4, 0, 2, 7}, {0, 1, 2, 3, 4}) == std::vector<int>{4, 0, 2});
+  REQUIRE(IntersectCpus({8, 9}, {0, 1}).empty());
+  REQUIRE(IntersectCpus({0, 1}, {}).empty());
+}
+
+TEST_CASE("Allowed CPUs") {
+  auto allowed = GetAllowedCpus();
+  REQUIRE(!allowed.empty());
+  REQUIRE(SetThreadAffinity(allowed));
+  std::vector<int> not_allowed;
+  for (int cpu = 0; cpu < CPU_SETSIZE && not_allowed.empty(); ++cpu) {
+    if (IntersectCpus({cpu}, allowed).empty())
+      not_allowed.push_back(cpu);
+  }
+  if (!not_allowed.empty()) {
+    REQUIRE(!SetThreadAffinity(not_allowed));
+    ScopedThreadAffinity affinity(not_allowed);
+    REQUIRE(!affinity.Succeeded());
+  }
+}
+
+TEST_CASE("Thread affinity out of range") {
+  REQUIRE_THROWS_AS(SetThreadAffinity({-1}), DaliBackendException);
+  REQUIRE_THROWS_AS(SetThreadAffinity({CPU_SETSIZE}), DaliBackendException);
+}
+
+TEST_CASE("Scoped thread affinity") {
+  cpu_set_t before;
+  REQUIRE(pthread_getaffinity_np(pthread_self(), sizeof(before), &before) == 0);
+  {
+    int cpu = GetAllowedCpus().at(0);
+    ScopedThreadAffinity affinity({cpu});
+    REQUIRE(affinity.Succeeded());
+    cpu_set_t pinned;
+    REQUIRE(pthread_getaffinity_np(pthread_self(), sizeof(pinned), &pinned) == 0);
+    REQUIRE(CPU_COUNT(&pinned) == 1);
+    REQUIRE(CPU_ISSET(cpu, &pinned));
+  }
+  cpu_set_t after;
+  REQUIRE(pthread_getaffinity_np(pthread_self(), sizeof(after), &after) == 0);
+  REQUIRE(CPU_EQUAL(&before, &after));
+}
+
+}}}}  // namespace triton::backend::dali::test
@@ -21,6 +21,10 @@
 // SOFTWARE.
 
 #include "src/dali_executor/dali_executor.h"
+
+#include <algorithm>
+#include <cstring>
+
 #include "src/dali_executor/utils/dali.h"
 
 namespace triton { namespace backend { namespace dali {
@@ -32,7 +36,11 @@ void DaliExecutor::SetupInputs(const std::vector<IDescr>& inputs) {
     assert(inputs[i].meta.shape.num_samples() == batch_size &&
            "All inputs should have equal batch size.");
   }
+  TRITON_DALI_RANGE(range, make_string("SetupInputs bs=", batch_size), TimeRange::kBlue);
+  TimeInterval copy_interval{};
+  start_timer_ns(copy_interval);
   std::vector<IDescr> c_inputs{};
+  std::vector<PooledIOBuffer> interm_buffers{};
   for (auto& inp : inputs) {
     size_t inp_size = inp.meta.shape.num_elements() * dali_type_size(inp.meta.type);
     if (IsNoCopy(inp)) {
@@ -40,52 +48,77 @@ void DaliExecutor::SetupInputs(const std::vector<IDescr>& inputs) {
       c_inputs.push_back(inp);
     } else {
       // Copy buffers to a contiguous buffer on the proper device
-      c_inputs.push_back(ScheduleInputCopy(inp));
+      c_inputs.push_back(ScheduleInputCopy(inp, interm_buffers));
       assert(inp_size <= c_inputs.back().buffers[0].size);
     }
   }
   WaitForCopies();
+  end_timer_ns(copy_interval);
+  run_timings_.input_copy_ns += duration_ns(copy_interval);
   for (auto& inp : c_inputs) {
-    pipeline_.SetInput(inp);
+    pipeline_.SetInput(inp, options_.no_copy_inputs);
   }
+  input_buffers_ = std::move(interm_buffers);
 }
 
 
-IOBufferI* DaliExecutor::GetInputBuffer(const std::string& name, device_type_t device) {
-  IOBufferI* buffer;
+PooledIOBuffer DaliExecutor::AllocateBuffer(device_type_t device, size_t size) {
   if (device == device_type_t::CPU) {
-    buffer = &cpu_buffers_[name + "_inp"];
-  } else {
-    buffer = &gpu_buffers_[name + "_inp"];
+    return PooledIOBuffer(host_pool_, size);
   }
-  return buffer;
+  ENFORCE(device_pool_, "GPU buffer requested for a pipeline without a device.");
+  return PooledIOBuffer(device_pool_, size);
 }
 
 
-IOBufferI* DaliExecutor::GetOutputBuffer(const std::string& name, device_type_t device) {
-  IOBufferI* buffer;
-  if (device == device_type_t::CPU) {
-    buffer = &cpu_buffers_[name + "_out"];
-  } else {
-    buffer = &gpu_buffers_[name + "_out"];
-  }
-  return buffer;
+void DaliExecutor::ReserveBuffers(device_type_t device, size_t size, int count) {
+  if (size == 0)
+    return;
+  bool fits = true;
+  if (device == device_type_t::CPU)
+    fits = host_pool_->Reserve(size, count);
+  else if (device_pool_)
+    fits = device_pool_->Reserve(size, count);
+  if (!fits)
+    reservation_exceeds_cache_ = true;
 }
 
+void DaliExecutor::ReserveOutputBuffers() {
+  if (output_buffers_reserved_)
+    return;
+  output_buffers_reserved_ = true;
+  auto& sizes = options_.output_batch_bytes;
+  for (int out_idx = 0; out_idx < static_cast<int>(sizes.size()); out_idx++) {
+    if (out_idx < pipeline_.GetNumOutput())
+      ReserveBuffers(pipeline_.GetOutputDevice(out_idx), sizes[out_idx], 1);
+  }
+}
 
-IDescr DaliExecutor::ScheduleInputCopy(const IDescr& input) {
+IDescr DaliExecutor::ScheduleInputCopy(const IDescr& input,
+                                       std::vector<PooledIOBuffer>& interm_buffers) {
   assert(input.buffers.size() > 0);
-  IOBufferI* buffer = GetInputBuffer(input.meta.name, input.buffers[0].device);
   size_t size = 0;
   for (auto& buf : input.buffers)
     size += buf.size;
-  buffer->resize(size);
-  auto descriptor = buffer->get_descr();
+  interm_buffers.push_back(AllocateBuffer(input.buffers[0].device, size));
+  auto descriptor = interm_buffers.back().get_descr();
   char* dst = reinterpret_cast<char*>(descriptor.data);
+  bool same_device = std::all_of(input.buffers.begin(), input.buffers.end(),
+                                 [&](const IBufferDescr& buf) {
+                                   return buf.device == descriptor.device;
+                                 });
+  if (same_device && input.buffers.size() > 1) {
+    if (descriptor.device == device_type_t::CPU)
+      ScheduleHostGather(input.buffers, dst, size);
+    else
+      ScheduleDeviceGather(input.buffers, dst);
+    return IDescr{input.meta, {descriptor}};
+  }
   auto stream = pipeline_.CopyStream();
   for (auto& buf : input.buffers) {
     thread_pool_.AddWork(
         [stream, descriptor, dst, buf](int) {
+          TRITON_DALI_RANGE(range, make_string("Input copy ", buf.size, "B"), TimeRange::kOrange);
           MemCopy(descriptor.device, dst, buf.device, buf.data, buf.size, stream);
         },
         buf.size, true);
@@ -94,68 +127,573 @@ IDescr DaliExecutor::ScheduleInputCopy(const IDescr& input) {
   return IDescr{input.meta, {descriptor}};
 }
 
-void DaliExecutor::ScheduleOutputCopy(const ODescr& output, int output_idx) {
-  const auto& name = output.meta.name;
+void DaliExecutor::ScheduleHostGather(const std::vector<IBufferDescr>& chunks, char* dst,
+                                      size_t total_size) {
+  constexpr size_t kMinTaskSize = 256 << 10;  // below that, a task costs more than the copy
+  size_t num_threads = thread_pool_.NumThreads();
+  size_t task_size = std::max(kMinTaskSize, (total_size + num_threads - 1) / num_threads);
+  struct Range {
+    char* dst;
+    const char* src;
+    size_t size;
+  };
+  std::vector<Range> ranges;
+  size_t ranges_size = 0;
+  auto add_task = [&]() {
+    thread_pool_.AddWork(
+        [ranges, ranges_size](int) {
+          TRITON_DALI_RANGE(range,
+                            make_string("Input gather ", ranges.size(), "x", ranges_size, "B"),
+                            TimeRange::kOrange);
+          for (auto& r : ranges) {
+            std::memcpy(r.dst, r.src, r.size);
+          }
+        },
+        ranges_size, true);
+    ranges.clear();
+    ranges_size = 0;
+  };
+  for (auto& chunk : chunks) {
+    auto src = reinterpret_cast<const char*>(chunk.data);
+    size_t offset = 0;
+    while (offset < chunk.size) {
+      size_t n = std::min(chunk.size - offset, task_size - ranges_size);
+      ranges.push_back({dst, src + offset, n});
+      ranges_size += n;
+      dst += n;
+      offset += n;
+      if (ranges_size == task_size)
+        add_task();
+    }
+  }
+  if (!ranges.empty())
+    add_task();
+}
+
+void DaliExecutor::ScheduleDeviceGather(const std::vector<IBufferDescr>& chunks, char* dst) {
+  if (!device_gather_)
+    device_gather_ = std::make_unique<ScatterGatherGPU>();
+  for (auto& chunk : chunks) {
+    device_gather_->AddCopy(dst, chunk.data, chunk.size);
+    dst += chunk.size;
+  }
+  // Adjacent chunks are merged and the large ones are split into blocks of similar size
+  device_gather_->Run(pipeline_.CopyStream(), true, ScatterGatherGPU::Method::Default,
+                      cudaMemcpyDeviceToDevice);
+}
+
+void DaliExecutor::ScheduleOutputCopy(const ODescr& output, int output_idx,
+                                      std::vector<PooledIOBuffer>& interm_buffers,
+                                      bool use_thread_pool, RequestCopyTracker* tracker) {
+  if (ScheduleOutputScatter(output, output_idx)) {
+    if (tracker)
+      tracker->MarkAll(OutputStream(output_idx));
+    return;
+  }
   const auto& out_buffers = output.buffers;
   size_t size = 0;
   for (auto& out_buff : out_buffers) {
     size += out_buff.size;
   }
-  IOBufferI* interm_buffer = GetOutputBuffer(name, pipeline_.GetOutputDevice(output_idx));
-  interm_buffer->resize(size);
-  auto interm_descr = interm_buffer->get_descr();
-  pipeline_.PutOutput(interm_descr.data, output_idx, interm_descr.device);
+  interm_buffers.push_back(AllocateBuffer(pipeline_.GetOutputDevice(output_idx), size));
+  auto interm_descr = interm_buffers.back().get_descr();
+  auto stream = OutputStream(output_idx);
+  pipeline_.PutOutput(interm_descr.data, output_idx, interm_descr.device, stream);
   char* src = reinterpret_cast<char*>(interm_descr.data);
-  auto stream = pipeline_.CopyStream();
-  for (auto& buf : out_buffers) {
-    thread_pool_.AddWork(
-        [stream, src, buf, interm_descr](int) {
-          MemCopy(buf.device, buf.data, interm_descr.device, src, buf.size, stream);
-        },
-        buf.size);
+  for (size_t buf_idx = 0; buf_idx < out_buffers.size(); ++buf_idx) {
+    auto& buf = out_buffers[buf_idx];
+    if (use_thread_pool) {
+      ThreadPool::Work copy = [stream, src, buf, interm_descr](int) {
+        TRITON_DALI_RANGE(range, make_string("Output copy ", buf.size, "B"), TimeRange::kYellow);
+        MemCopy(buf.device, buf.data, interm_descr.device, src, buf.size, stream);
+      };
+      if (tracker)
+        thread_pool_.AddWork(tracker->Track(buf_idx, stream, std::move(copy)), buf.size, true);
+      else
+        thread_pool_.AddWork(std::move(copy), buf.size);
+    } else {
+      MemCopy(buf.device, buf.data, interm_descr.device, src, buf.size, stream);
+      if (tracker)
+        tracker->Mark(buf_idx, stream);
+    }
     src += buf.size;
   }
 }
 
+bool DaliExecutor::ScheduleOutputScatter(const ODescr& output, int output_idx) {
+  const auto& out_buffers = output.buffers;
+  auto device = out_buffers[0].device;
+  size_t total_size = 0;
+  for (auto& buf : out_buffers) {
+    if (buf.device != device)
+      return false;
+    total_size += buf.size;
+  }
+  TensorListShape<> queried_shape;
+  if (output.meta.shape.num_samples() == 0)
+    pipeline_.GetOutputShapeAt(output_idx, queried_shape);
+  const auto& shape = output.meta.shape.num_samples() > 0 ? output.meta.shape : queried_shape;
+  auto type_size = dali_type_size(pipeline_.GetOutputType(output_idx));
+  if (static_cast<size_t>(shape.num_elements() * type_size) != total_size)
+    return false;
+  std::vector<void*> dsts(shape.num_samples());
+  size_t buf_idx = 0;
+  size_t offset = 0;
+  for (int64_t sample_idx = 0; sample_idx < shape.num_samples(); ++sample_idx) {
+    size_t sample_size = volume(shape.tensor_shape_span(sample_idx)) * type_size;
+    while (buf_idx < out_buffers.size() && offset + sample_size > out_buffers[buf_idx].size) {
+      if (offset != out_buffers[buf_idx].size)
+        return false;  // the sample spans two chunks
+      buf_idx++;
+      offset = 0;
+    }
+    if (buf_idx == out_buffers.size())
+      return false;
+    dsts[sample_idx] = reinterpret_cast<char*>(out_buffers[buf_idx].data) + offset;
+    offset += sample_size;
+  }
+  pipeline_.PutOutputSamples(dsts, output_idx, device, OutputStream(output_idx));
+  return true;
+}
+
 void DaliExecutor::WaitForCopies() {
   thread_pool_.RunAll();
   pipeline_.SyncStream();
 }
 
+void DaliExecutor::RequestCopyTracker::Mark(size_t request_idx, cudaStream_t stream) {
+  if (device_id_ < 0)
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  request_events_[request_idx].push_back(Record(stream));
+}
+
+void DaliExecutor::RequestCopyTracker::MarkAll(cudaStream_t stream) {
+  if (device_id_ < 0)
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto event = Record(stream);
+  for (auto& events : request_events_) {
+    events.push_back(event);
+  }
+}
+
+ThreadPool::Work DaliExecutor::RequestCopyTracker::Track(size_t request_idx, cudaStream_t stream,
+                                                         ThreadPool::Work copy) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_[request_idx]++;
+  }
+  return [this, request_idx, stream, copy](int thread_id) {
+    try {
+      copy(thread_id);
+      Mark(request_idx, stream);
+    } catch (...) {
+      Done(request_idx, false);
+      throw;
+    }
+    Done(request_idx, true);
+  };
+}
+
+void DaliExecutor::RequestCopyTracker::Done(size_t request_idx, bool ok) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_[request_idx]--;
+  if (!ok)
+    failed_[request_idx] = true;
+  copied_.notify_all();
+}
+
+bool DaliExecutor::RequestCopyTracker::Wait(size_t request_idx) {
+  std::vector<cudaEvent_t> events;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    copied_.wait(lock, [&]() { return pending_[request_idx] == 0; });
+    if (failed_[request_idx])
+      return false;
+    events = request_events_[request_idx];
+  }
+  for (auto event : events) {
+    CUDA_CALL_GUARD(cudaEventSynchronize(event));
+  }
+  return true;
+}
+
+cudaEvent_t DaliExecutor::RequestCopyTracker::Record(cudaStream_t stream) {
+  if (used_events_ == event_pool_.size()) {
+    event_pool_.push_back(CUDAEvent::CreateWithFlags(cudaEventDisableTiming, device_id_));
+  }
+  cudaEvent_t event = event_pool_[used_events_++];
+  CUDA_CALL_GUARD(cudaEventRecord(event, stream));
+  return event;
+}
+
+void DaliExecutor::WaitForOutputCopies(bool use_thread_pool) {
+  if (use_thread_pool)
+    thread_pool_.RunAll();
+  if (output_streams_.empty()) {
+    pipeline_.SyncStream();
+    return;
+  }
+  DeviceGuard dg(pipeline_.DeviceId());
+  for (size_t i = 0; i < output_streams_.size(); ++i) {
+    CUDA_CALL_GUARD(cudaEventRecord(output_events_[i], output_streams_[i]));
+  }
+  for (auto& event : output_events_) {
+    CUDA_CALL_GUARD(cudaEventSynchronize(event));
+  }
+}
+
 
 bool DaliExecutor::IsNoCopy(const IDescr& input) {
   return input.buffers.size() == 1 && (input.buffers[0].device == device_type_t::CPU ||
                                        input.buffers[0].device_id == pipeline_.DeviceId());
 }
 
-std::vector<OutputInfo> DaliExecutor::Run(const std::vector<IDescr>& inputs) {
+int DaliExecutor::MicroBatchSize() const {
+  int max_batch_size = pipeline_.MaxBatchSize();
+  int micro_batch_size = options_.micro_batch_size;
+  if (max_batch_size > 0 && (micro_batch_size <= 0 || micro_batch_size > max_batch_size)) {
+    micro_batch_size = max_batch_size;
+  }
+  return micro_batch_size;
+}
+
+const std::vector<OutputInfo>& DaliExecutor::Run(const std::vector<IDescr>& inputs) {
+  assert(!inputs.empty());
+  staged_outputs_.clear();
+  run_timings_ = {};
+  int batch_size = inputs[0].meta.shape.num_samples();
+  TRITON_DALI_RANGE(range, make_string("Executor Run bs=", batch_size), TimeRange::kBlue1);
+  int micro_batch_size = MicroBatchSize();
+  if (micro_batch_size > 0 && batch_size > micro_batch_size) {
+    RunMicroBatches(inputs, micro_batch_size);
+    ReserveOutputBuffers();
+    return outputs_info_;
+  }
+  RunBatch(inputs);
+  ReserveOutputBuffers();
+  TimeInterval shape_interval{};
+  start_timer_ns(shape_interval);
+  QueryOutputShapes();
+  outputs_info_.resize(output_shapes_.size());
+  for (size_t out_idx = 0; out_idx < outputs_info_.size(); out_idx++) {
+    auto& info = outputs_info_[out_idx];
+    info.shape = output_shapes_[out_idx];
+    info.type = pipeline_.GetOutputType(out_idx);
+    info.device = pipeline_.GetOutputDevice(out_idx);
+  }
+  end_timer_ns(shape_interval);
+  run_timings_.output_shape_ns = duration_ns(shape_interval);
+  return outputs_info_;
+}
+
+void DaliExecutor::QueryOutputShapes() {
+  output_shapes_.resize(pipeline_.GetNumOutput());
+  for (size_t out_idx = 0; out_idx < output_shapes_.size(); out_idx++) {
+    pipeline_.GetOutputShapeAt(out_idx, output_shapes_[out_idx]);
+  }
+}
+
+void DaliExecutor::ResetPipeline() {
+  if (!standby_.valid()) {
+    pipeline_.Reset();
+    return;
+  }
+  // The first standby is cloned from pipeline_, which can't be moved before that's done
+  standby_.wait();
+  DaliPipeline failed = std::move(pipeline_);
+  try {
+    pipeline_ = standby_.get();
+  } catch (...) {
+    // The standby couldn't be built, so there's no replacement ready
+    pipeline_ = std::move(failed);
+    pipeline_.Reset();
+    return;
+  }
+  standby_ = std::async(std::launch::async, [](DaliPipeline pipeline) {
+    DeviceGuard dg(pipeline.DeviceId());
+    pipeline.Reset();
+    return pipeline;
+  }, std::move(failed));
+}
+
+void DaliExecutor::RunBatch(const std::vector<IDescr>& inputs) {
   SetupInputs(inputs);
+  TimeInterval run_interval{};
+  start_timer_ns(run_interval);
   try {
     pipeline_.Run();
+    WaitForPendingOutputs();
     pipeline_.Output();
   } catch (std::runtime_error& e) {
-    pipeline_.Reset();
+    WaitForPendingOutputs();
+    input_buffers_.clear();
+    ResetPipeline();
+    throw e;
+  }
+  end_timer_ns(run_interval);
+  run_timings_.run_ns = duration_ns(run_interval);
+  input_buffers_.clear();
+}
+
+void DaliExecutor::RunMicroBatches(const std::vector<IDescr>& inputs, int micro_batch_size) {
+  int batch_size = inputs[0].meta.shape.num_samples();
+  try {
+    for (int begin = 0; begin < batch_size; begin += micro_batch_size) {
+      int end = std::min(begin + micro_batch_size, batch_size);
+      TRITON_DALI_RANGE(mb_range, make_string("Micro-batch ", begin, "-", end), TimeRange::kBlue);
+      std::vector<IDescr> micro_batch;
+      micro_batch.reserve(inputs.size());
+      for (auto& inp : inputs) {
+        micro_batch.push_back(SliceInput(inp, begin, end));
+      }
+      // Gathering the inputs overlaps with staging the outputs of the previous micro-batch.
+      // SetupInputs waits for both, before the previous outputs are released by DALI.
+      SetupInputs(micro_batch);
+      TimeInterval run_interval{};
+      start_timer_ns(run_interval);
+      pipeline_.Run();
+      WaitForPendingOutputs();
+      pipeline_.Output();
+      end_timer_ns(run_interval);
+      run_timings_.run_ns += duration_ns(run_interval);
+      StageOutputs();
+    }
+    WaitForCopies();
+  } catch (std::runtime_error& e) {
+    WaitForPendingOutputs();
+    WaitForCopies();
+    input_buffers_.clear();
+    staged_outputs_.clear();
+    ResetPipeline();
     throw e;
   }
-  std::vector<OutputInfo> ret(pipeline_.GetNumOutput());
-  auto outputs_shapes = pipeline_.GetOutputShapes();
-  for (size_t out_idx = 0; out_idx < ret.size(); out_idx++) {
-    ret[out_idx] = {outputs_shapes[out_idx], pipeline_.GetOutputType(out_idx),
-                    pipeline_.GetOutputDevice(out_idx)};
+  input_buffers_.clear();
+  outputs_info_.resize(staged_outputs_.size());
+  for (size_t out_idx = 0; out_idx < outputs_info_.size(); out_idx++) {
+    auto& staged = staged_outputs_[out_idx];
+    outputs_info_[out_idx] = {cat_list_shapes(staged.shapes), staged.type, staged.device};
+  }
+}
+
+IDescr DaliExecutor::SliceInput(const IDescr& input, int begin, int end) {
+  const auto& shape = input.meta.shape;
+  auto type_size = dali_type_size(input.meta.type);
+  size_t offset = 0;
+  for (int sample_idx = 0; sample_idx < begin; ++sample_idx) {
+    offset += volume(shape.tensor_shape_span(sample_idx)) * type_size;
+  }
+  IDescr slice;
+  slice.meta = input.meta;
+  slice.meta.shape = TensorListShape<>(end - begin, shape.sample_dim());
+  size_t size = 0;
+  for (int sample_idx = begin; sample_idx < end; ++sample_idx) {
+    slice.meta.shape.set_tensor_shape(sample_idx - begin, shape.tensor_shape_span(sample_idx));
+    size += volume(shape.tensor_shape_span(sample_idx)) * type_size;
+  }
+  for (auto& buf : input.buffers) {
+    if (size == 0)
+      break;
+    if (offset >= buf.size) {
+      offset -= buf.size;
+      continue;
+    }
+    IBufferDescr part = buf;
+    part.data = reinterpret_cast<const char*>(buf.data) + offset;
+    part.size = std::min(buf.size - offset, size);
+    size -= part.size;
+    offset = 0;
+    slice.buffers.push_back(part);
+  }
+  ENFORCE(size == 0, make_string("Buffers of input ", input.meta.name,
+                                 " are smaller than its shape indicates."));
+  if (slice.buffers.empty()) {
+    IBufferDescr empty = input.buffers[0];
+    empty.size = 0;
+    slice.buffers.push_back(empty);
   }
-  return ret;
+  return slice;
 }
 
-void DaliExecutor::PutOutputs(const std::vector<ODescr>& outputs) {
+void DaliExecutor::StageOutputs() {
+  TRITON_DALI_RANGE(range, "StageOutputs", TimeRange::kViolet);
+  TimeInterval shape_interval{};
+  start_timer_ns(shape_interval);
+  QueryOutputShapes();
+  end_timer_ns(shape_interval);
+  run_timings_.output_shape_ns += duration_ns(shape_interval);
+  staged_outputs_.resize(output_shapes_.size());
+  for (size_t out_idx = 0; out_idx < output_shapes_.size(); ++out_idx) {
+    auto& staged = staged_outputs_[out_idx];
+    staged.type = pipeline_.GetOutputType(out_idx);
+    staged.device = pipeline_.GetOutputDevice(out_idx);
+    size_t size = output_shapes_[out_idx].num_elements() * dali_type_size(staged.type);
+    staged.buffers.push_back(AllocateBuffer(staged.device, size));
+    staged.shapes.push_back(output_shapes_[out_idx]);
+    if (size > 0) {
+      auto descr = staged.buffers.back().get_descr();
+      pipeline_.PutOutput(descr.data, out_idx, descr.device);
+    }
+  }
+}
+
+void DaliExecutor::ScheduleStagedCopy(const StagedOutput& staged, const ODescr& output,
+                                      int output_idx, bool use_thread_pool,
+                                      RequestCopyTracker* tracker) {
+  auto stream = OutputStream(output_idx);
+  auto dst_it = output.buffers.begin();
+  size_t dst_offset = 0;
+  for (auto& staged_buffer : staged.buffers) {
+    auto src = staged_buffer.get_descr();
+    size_t src_offset = 0;
+    while (src_offset < src.size) {
+      ENFORCE(dst_it != output.buffers.end(),
+              make_string("Output ", output.meta.name, " doesn't fit in the provided buffers."));
+      size_t size = std::min(src.size - src_offset, dst_it->size - dst_offset);
+      auto src_ptr = reinterpret_cast<const char*>(src.data) + src_offset;
+      auto dst_ptr = reinterpret_cast<char*>(dst_it->data) + dst_offset;
+      auto dst_dev = dst_it->device;
+      auto copy = [=](int) {
+        TRITON_DALI_RANGE(range, make_string("Output copy ", size, "B"), TimeRange::kYellow);
+        MemCopy(dst_dev, dst_ptr, src.device, src_ptr, size, stream);
+      };
+      size_t request_idx = dst_it - output.buffers.begin();
+      if (use_thread_pool && tracker) {
+        thread_pool_.AddWork(tracker->Track(request_idx, stream, copy), size, true);
+      } else if (use_thread_pool) {
+        thread_pool_.AddWork(copy, size);
+      } else {
+        copy(0);
+      }
+      src_offset += size;
+      dst_offset += size;
+      if (dst_offset == dst_it->size) {
+        if (tracker && !use_thread_pool)
+          tracker->Mark(request_idx, stream);
+        ++dst_it;
+        dst_offset = 0;
+      }
+    }
+  }
+  if (tracker) {
+    for (; dst_it != output.buffers.end(); ++dst_it) {
+      tracker->Mark(dst_it - output.buffers.begin(), stream);
+    }
+  }
+}
+
+void DaliExecutor::ScheduleOutputsCopy(const std::vector<ODescr>& outputs,
+                                       const std::vector<StagedOutput>& staged,
+                                       std::vector<PooledIOBuffer>& interm_buffers,
+                                       bool use_thread_pool, RequestCopyTracker* tracker) {
   for (uint32_t output_idx = 0; output_idx < outputs.size(); ++output_idx) {
-    if (outputs[output_idx].buffers.size() == 1) {
-      auto buffer = outputs[output_idx].buffers[0];
-      pipeline_.PutOutput(buffer.data, output_idx, buffer.device);
+    const auto& output = outputs[output_idx];
+    if (!staged.empty()) {
+      ScheduleStagedCopy(staged[output_idx], output, output_idx, use_thread_pool, tracker);
+    } else if (output.buffers.size() == 1) {
+      auto stream = OutputStream(output_idx);
+      pipeline_.PutOutput(output.buffers[0].data, output_idx, output.buffers[0].device, stream);
+      if (tracker)
+        tracker->Mark(0, stream);
     } else {
-      ScheduleOutputCopy(outputs[output_idx], output_idx);
+      ScheduleOutputCopy(output, output_idx, interm_buffers, use_thread_pool, tracker);
     }
   }
-  WaitForCopies();
+}
+
+void DaliExecutor::CopyOutputs(const std::vector<ODescr>& outputs,
+                               const std::vector<StagedOutput>& staged, bool use_thread_pool,
+                               const RequestCopiedCallback& on_request_copied) {
+  std::vector<PooledIOBuffer> interm_buffers{};
+  if (!on_request_copied || outputs.empty()) {
+    ScheduleOutputsCopy(outputs, staged, interm_buffers, use_thread_pool, nullptr);
+    WaitForOutputCopies(use_thread_pool);
+    return;
+  }
+  size_t num_requests = outputs[0].buffers.size();
+  for (auto& output : outputs) {
+    ENFORCE(output.buffers.size() == num_requests,
+            "Every output has to have a buffer for each request.");
+  }
+  RequestCopyTracker tracker(request_events_, pipeline_.DeviceId(), num_requests);
+  try {
+    ScheduleOutputsCopy(outputs, staged, interm_buffers, use_thread_pool, &tracker);
+    for (size_t request_idx = 0; request_idx < num_requests; ++request_idx) {
+      if (!tracker.Wait(request_idx))
+        break;  // the error is raised by WaitForOutputCopies
+      on_request_copied(request_idx);
+    }
+  } catch (...) {
+    if (use_thread_pool)
+      thread_pool_.RunAll();  // the tasks refer to the tracker and the intermediate buffers
+    throw;
+  }
+  WaitForOutputCopies(use_thread_pool);
+}
+
+void DaliExecutor::PutOutputs(const std::vector<ODescr>& outputs,
+                              const RequestCopiedCallback& on_request_copied) {
+  CopyOutputs(outputs, staged_outputs_, true, on_request_copied);
+  staged_outputs_.clear();
+}
+
+void DaliExecutor::PutOutputsAsync(std::vector<ODescr> outputs,
+                                   std::function<void(std::exception_ptr)> on_done,
+                                   RequestCopiedCallback on_request_copied) {
+  WaitForPendingOutputs();
+  auto copied = std::make_shared<std::promise<void>>();
+  auto staged = std::make_shared<std::vector<StagedOutput>>(std::move(staged_outputs_));
+  staged_outputs_.clear();
+  pending_outputs_ = copied->get_future().share();
+  pending_task_ = std::async(std::launch::async, [this, outputs, on_done, on_request_copied,
+                                                  copied, staged]() {
+    std::exception_ptr error{};
+    try {
+      DeviceGuard dg(pipeline_.DeviceId());
+      CopyOutputs(outputs, *staged, false, on_request_copied);
+      staged->clear();
+    } catch (...) { error = std::current_exception(); }
+    copied->set_value();
+    on_done(error);
+  });
+}
+
+void DaliExecutor::WarmUp(const std::vector<IDescr>& samples,
+                          const std::vector<int>& batch_sizes) {
+  for (int batch_size : batch_sizes) {
+    std::vector<IDescr> inputs;
+    for (auto& sample : samples) {
+      ENFORCE(sample.meta.shape.num_samples() == 1,
+              make_string("Warm-up input ", sample.meta.name, " should be a single sample."));
+      IDescr input;
+      input.meta = sample.meta;
+      input.meta.shape =
+          TensorListShape<>::make_uniform(batch_size, sample.meta.shape.tensor_shape(0));
+      for (int i = 0; i < batch_size; ++i) {
+        input.buffers.insert(input.buffers.end(), sample.buffers.begin(), sample.buffers.end());
+      }
+      inputs.push_back(std::move(input));
+    }
+    auto outputs_info = Run(inputs);
+    std::vector<PooledIOBuffer> buffers;
+    std::vector<ODescr> outputs(outputs_info.size());
+    for (size_t out_idx = 0; out_idx < outputs_info.size(); ++out_idx) {
+      auto& info = outputs_info[out_idx];
+      size_t size = info.shape.num_elements() * dali_type_size(info.type);
+      buffers.push_back(AllocateBuffer(info.device, size));
+      outputs[out_idx].meta.type = info.type;
+      outputs[out_idx].meta.shape = info.shape;
+      outputs[out_idx].buffers = {buffers.back().get_descr()};
+    }
+    PutOutputs(outputs);
+  }
+}
+
+void DaliExecutor::WaitForPendingOutputs() {
+  if (pending_outputs_.valid()) {
+    pending_outputs_.wait();
+  }
 }
 
 }}}  // namespace triton::backend::dali
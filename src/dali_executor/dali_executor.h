@@ -23,13 +23,21 @@
 #ifndef DALI_BACKEND_DALI_EXECUTOR_DALI_EXECUTOR_H_
 #define DALI_BACKEND_DALI_EXECUTOR_DALI_EXECUTOR_H_
 
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "src/dali_executor/dali_pipeline.h"
 #include "src/dali_executor/io_buffer.h"
 #include "src/dali_executor/io_descriptor.h"
+#include "src/utils/timing.h"
 
 
 namespace triton { namespace backend { namespace dali {
@@ -41,68 +49,470 @@ struct OutputInfo {
   device_type_t device;
 };
 
+struct ExecutorOptions {
+  /**
+   * Hand the inputs over to DALI without copying them.
+   * The inputs provided to Run have to stay valid until it returns.
+   */
+  bool no_copy_inputs = false;
+
+  /**
+   * Stage the host copies in the page-locked memory, if the pipeline has a GPU.
+   */
+  bool pinned_staging = true;
+
+  /**
+   * Upper bound for the memory kept for reuse by the intermediate buffers pools.
+   * The pools are shared by all the executors, so the smallest limit applies.
+   * Negative value means no limit.
+   */
+  int64_t max_cached_bytes = -1;
+
+  /**
+   * Batches larger than this are processed in parts (micro-batches) of this size.
+   * The size is capped by the maximum batch size of the pipeline.
+   * 0 means the maximum batch size of the pipeline.
+   */
+  int micro_batch_size = 0;
+
+  /**
+   * Number of CUDA streams, across which the copies of the outputs are spread (one per output).
+   * Copies of the inputs and of the staged micro-batch outputs use the pipeline's copy stream.
+   */
+  int num_copy_streams = 4;
+
+  /**
+   * Number of the threads copying the inputs and outputs.
+   * 0 means as many as the worker threads of the pipeline.
+   */
+  int num_copy_threads = 0;
+
+  /**
+   * Expected size of a whole batch of each input (at the maximum batch size) and the device
+   * of its buffers. Staging buffers of that size are reserved in the pools up front,
+   * so that the batches don't wait for the allocations, when the traffic starts.
+   */
+  std::vector<std::pair<device_type_t, size_t>> input_batch_bytes{};
+
+  /**
+   * Expected size of a whole batch of each output, indexed by the output. 0 if not known.
+   * The intermediate buffers are reserved on the device of the output after the first run.
+   */
+  std::vector<size_t> output_batch_bytes{};
+
+  /**
+   * Keep a second, ready to use, instance of the pipeline. When a run fails, the standby
+   * pipeline takes over at once and the failed one is rebuilt in the background,
+   * to become the next standby. Costs the memory of the second pipeline.
+   */
+  bool standby_pipeline = false;
+};
+
+/**
+ * @brief Time spent in the stages of the last DaliExecutor::Run.
+ */
+struct RunTimings {
+  int64_t input_copy_ns = 0;    // gathering the inputs in contiguous buffers
+  int64_t run_ns = 0;           // running the pipeline and waiting for its outputs
+  int64_t output_shape_ns = 0;  // querying the output shapes
+};
+
+struct ExecutorMemoryStats {
+  MemoryPool::Stats host;        // staging buffers on the host, shared with other executors
+  MemoryPool::Stats device;      // staging buffers on the device, shared with other executors
+  PipelineMemoryStats pipeline;  // outputs of the operators, if the pipeline collects them
+};
+
 class DaliExecutor {
  public:
-  DaliExecutor(DaliPipeline pipeline) :
-      pipeline_(std::move(pipeline)), thread_pool_(GetNumThreads(), pipeline_.DeviceId(), false) {}
+  DaliExecutor(DaliPipeline pipeline, ExecutorOptions options = {}) :
+      pipeline_(std::move(pipeline)),
+      options_(options),
+      thread_pool_(GetNumThreads(), pipeline_.DeviceId(), false) {
+    bool pinned = options_.pinned_staging && pipeline_.DeviceId() >= 0;
+    host_pool_ =
+        MemoryPool::Get(pinned ? MemoryKind::Pinned : MemoryKind::Host, pipeline_.DeviceId());
+    if (pipeline_.DeviceId() >= 0) {
+      device_pool_ = MemoryPool::Get(MemoryKind::Device, pipeline_.DeviceId());
+      for (int i = 0; i < options_.num_copy_streams; ++i) {
+        output_streams_.push_back(CUDAStream::Create(true, pipeline_.DeviceId()));
+        output_events_.push_back(
+            CUDAEvent::CreateWithFlags(cudaEventDisableTiming, pipeline_.DeviceId()));
+      }
+    }
+    if (options_.max_cached_bytes >= 0) {
+      host_cache_limit_ = host_pool_->LimitCachedBytes(options_.max_cached_bytes);
+      if (device_pool_)
+        device_cache_limit_ = device_pool_->LimitCachedBytes(options_.max_cached_bytes);
+    }
+    // Two sets, as the staging buffers of a batch are held until the next one is gathered
+    for (auto& input : options_.input_batch_bytes) {
+      ReserveBuffers(input.first, input.second, 2);
+    }
+    if (options_.standby_pipeline) {
+      standby_ = std::async(std::launch::async, [this]() {
+        DeviceGuard dg(pipeline_.DeviceId());
+        return pipeline_.Clone();
+      });
+    }
+  }
+
+  ~DaliExecutor() {
+    WaitForPendingOutputs();
+    WaitForAsyncOutputs();
+  }
 
   /**
    * @brief Run DALI pipeline.
-   * @return Outputs descriptors.
+   *
+   * If the pipeline is asynchronous, the outputs of the previous iteration are released
+   * only after the copies scheduled with PutOutputsAsync are finished.
+   * The inputs are consumed by the time this function returns. Intermediate input buffers
+   * are given back to the pool only then, so they can be shared with DALI without a copy.
+   *
+   * Batches larger than the micro-batch size are split and run part by part. The outputs
+   * of each part are staged in intermediate buffers, while the next part is being prepared.
+   * @return Outputs descriptors, valid until the next Run.
+   */
+  const std::vector<OutputInfo>& Run(const std::vector<IDescr>& inputs);
+
+  /**
+   * @brief Run the pipeline on a batch of copies of the given samples, once for each batch size.
+   *
+   * Lets DALI allocate its memory and initialize the operators before the first request.
+   * @param samples Descriptors of a single sample of every input.
+   */
+  void WarmUp(const std::vector<IDescr>& samples, const std::vector<int>& batch_sizes);
+
+  /**
+   * @brief Called with the index of a request (i.e. of a buffer of every output),
+   *        when all of the outputs of the request are copied.
    */
-  std::vector<OutputInfo> Run(const std::vector<IDescr>& inputs);
+  using RequestCopiedCallback = std::function<void(int)>;
 
   /**
    * @brief Copy pipeline outputs to the external buffers.
+   * @param on_request_copied If given, called from the calling thread for every request,
+   *                          in order, as soon as its outputs are copied.
+   */
+  void PutOutputs(const std::vector<ODescr>& outputs,
+                  const RequestCopiedCallback& on_request_copied = {});
+
+  /**
+   * @brief Copy pipeline outputs to the external buffers in the background.
+   *
+   * The call returns immediately, so that the next iteration can be started
+   * while the outputs are being copied.
+   * @param on_done Called from the background thread after the copies are finished.
+   *                Receives an exception raised during the copy, if any.
+   * @param on_request_copied If given, called from the background thread for every request,
+   *                          in order, as soon as its outputs are copied.
+   */
+  void PutOutputsAsync(std::vector<ODescr> outputs,
+                       std::function<void(std::exception_ptr)> on_done,
+                       RequestCopiedCallback on_request_copied = {});
+
+  /**
+   * @brief Check if any of the buffers reserved so far (with input_batch_bytes and,
+   *        after the first run, output_batch_bytes) didn't fit in the limit of the cached
+   *        memory of the pools, so that the reservation was partly lost.
+   */
+  bool ReservationExceedsCache() const {
+    return reservation_exceeds_cache_;
+  }
+
+  bool IsAsync() const {
+    return pipeline_.IsAsync();
+  }
+
+  /**
+   * @brief Wait until the outputs scheduled with PutOutputsAsync are copied
+   *        and the completion callbacks return.
+   */
+  void WaitForAsyncOutputs() {
+    if (pending_task_.valid()) {
+      pending_task_.wait();
+    }
+  }
+
+  const RunTimings& LastRunTimings() const {
+    return run_timings_;
+  }
+
+  /**
+   * @brief Get the usage of the intermediate buffers pools and of the memory of the pipeline.
+   *
+   * The pools are shared with other executors, so are their statistics.
    */
-  void PutOutputs(const std::vector<ODescr>& outputs);
+  ExecutorMemoryStats GetMemoryStats() {
+    ExecutorMemoryStats stats{};
+    stats.host = host_pool_->GetStats();
+    if (device_pool_)
+      stats.device = device_pool_->GetStats();
+    stats.pipeline = pipeline_.GetMemoryStats();
+    return stats;
+  }
 
  private:
+  /**
+   * @brief Tracks, with CUDA events, when the outputs of each request are copied.
+   *
+   * The events are marked from the thread issuing the copies, right after the copies
+   * to the buffers of a request are scheduled. The copies run in the thread pool
+   * are counted until they finish, and mark the events themselves.
+   */
+  class RequestCopyTracker {
+   public:
+    RequestCopyTracker(std::vector<CUDAEvent>& event_pool, int device_id, size_t num_requests) :
+        event_pool_(event_pool),
+        device_id_(device_id),
+        request_events_(num_requests),
+        pending_(num_requests, 0),
+        failed_(num_requests, false) {}
+
+    /**
+     * @brief Mark the copies to the buffers of a request scheduled on the \p stream so far.
+     */
+    void Mark(size_t request_idx, cudaStream_t stream);
+
+    /**
+     * @brief Mark the copies scheduled on the \p stream so far for all of the requests.
+     */
+    void MarkAll(cudaStream_t stream);
+
+    /**
+     * @brief Wrap a \p copy to the buffers of a request, to be run in the thread pool.
+     *
+     * The request is pending until the returned task finishes.
+     */
+    ThreadPool::Work Track(size_t request_idx, cudaStream_t stream, ThreadPool::Work copy);
+
+    /**
+     * @brief Wait for the pending and the marked copies of a request.
+     * @return False, if any of the copies run in the thread pool failed.
+     */
+    bool Wait(size_t request_idx);
+
+    size_t NumRequests() const {
+      return request_events_.size();
+    }
+
+   private:
+    void Done(size_t request_idx, bool ok);
+
+    cudaEvent_t Record(cudaStream_t stream);
+
+    std::vector<CUDAEvent>& event_pool_;
+    size_t used_events_ = 0;
+    int device_id_;
+    std::mutex mutex_;
+    std::condition_variable copied_;
+    std::vector<std::vector<cudaEvent_t>> request_events_;
+    std::vector<int> pending_;
+    std::vector<bool> failed_;
+  };
+
+  /**
+   * @brief Outputs of a batch processed in micro-batches.
+   */
+  struct StagedOutput {
+    std::vector<PooledIOBuffer> buffers;  // one per micro-batch
+    std::vector<TensorListShape<>> shapes;
+    dali_data_type_t type;
+    device_type_t device;
+  };
+
   void SetupInputs(const std::vector<IDescr>& inputs);
 
+  /**
+   * @brief Run the pipeline once, for the whole batch.
+   */
+  void RunBatch(const std::vector<IDescr>& inputs);
+
+  /**
+   * @brief Run the pipeline for every \p micro_batch_size samples of the batch.
+   *        The outputs are gathered in staged_outputs_.
+   */
+  void RunMicroBatches(const std::vector<IDescr>& inputs, int micro_batch_size);
+
+  /**
+   * @brief Bring the pipeline back to a usable state after a failed run.
+   *
+   * With a standby pipeline, it's swapped in and the failed pipeline is rebuilt
+   * in the background. Otherwise, the pipeline is rebuilt in place.
+   */
+  void ResetPipeline();
+
+  /**
+   * @brief Query the shapes of the current pipeline outputs into output_shapes_.
+   */
+  void QueryOutputShapes();
+
+  /**
+   * @brief Get a descriptor of the samples [begin, end) of the \p input. The data is not copied.
+   */
+  static IDescr SliceInput(const IDescr& input, int begin, int end);
+
+  /**
+   * @brief Schedule a copy of the current pipeline outputs to the staged_outputs_.
+   *        Call WaitForCopies() to wait for the copy to finish.
+   */
+  void StageOutputs();
+
+  /**
+   * @brief Schedule a copy of a \p staged output to a (possibly chunked) \p output.
+   *        Call WaitForOutputCopies() to wait for the copy to finish.
+   * @param use_thread_pool If false, the copies are issued from the calling thread.
+   */
+  void ScheduleStagedCopy(const StagedOutput& staged, const ODescr& output, int output_idx,
+                          bool use_thread_pool = true, RequestCopyTracker* tracker = nullptr);
+
+  /**
+   * @brief Schedule the copies of all the \p outputs, from the \p staged outputs if any.
+   *        Call WaitForOutputCopies() to wait for the copies to finish.
+   * @param tracker If given, tracks the copies of each request.
+   */
+  void ScheduleOutputsCopy(const std::vector<ODescr>& outputs,
+                           const std::vector<StagedOutput>& staged,
+                           std::vector<PooledIOBuffer>& interm_buffers, bool use_thread_pool,
+                           RequestCopyTracker* tracker);
+
+  /**
+   * @brief Copy the \p outputs and report the copied requests, if \p on_request_copied is given.
+   */
+  void CopyOutputs(const std::vector<ODescr>& outputs, const std::vector<StagedOutput>& staged,
+                   bool use_thread_pool, const RequestCopiedCallback& on_request_copied);
+
+  /**
+   * @brief Number of samples processed by a single run of the pipeline.
+   *        0 means no limit.
+   */
+  int MicroBatchSize() const;
+
   /**
    * @brief Schedule a copy of all buffers within input IDescr to a continuous buffer.
    *        Call WaitForCopies() to wait for the copy to finish.
+   * @param interm_buffers The new buffer is appended here.
    * @return IDecr to the new, continuous, buffer.
    */
-  IDescr ScheduleInputCopy(const IDescr& buffers);
+  IDescr ScheduleInputCopy(const IDescr& buffers, std::vector<PooledIOBuffer>& interm_buffers);
 
   /**
-   * @brief Schedule a copy to a chunked output through an intermediate buffer.
-   *        Call WaitForCopies() to wait for the copy to finish.
+   * @brief Schedule a gather of host \p chunks to a host buffer at \p dst.
+   *
+   * The work is split by size rather than by chunk: small chunks are grouped and large ones
+   * are split, so that each task of the thread pool copies about the same amount of data.
+   */
+  void ScheduleHostGather(const std::vector<IBufferDescr>& chunks, char* dst, size_t total_size);
+
+  /**
+   * @brief Schedule a gather of device \p chunks to a device buffer at \p dst
+   *        with a single scatter-gather kernel, on the pipeline's copy stream.
+   */
+  void ScheduleDeviceGather(const std::vector<IBufferDescr>& chunks, char* dst);
+
+  /**
+   * @brief Schedule a copy to a chunked output.
+   *        Call WaitForOutputCopies() to wait for the copy to finish.
+   *
+   * The samples are scattered directly to the output chunks if possible.
+   * Otherwise the output is copied through an intermediate buffer, which is appended
+   * to \p interm_buffers and has to be kept until the copy is finished.
+   * @param use_thread_pool If false, the copies are issued from the calling thread.
    */
-  void ScheduleOutputCopy(const ODescr& output, int output_idx);
+  void ScheduleOutputCopy(const ODescr& output, int output_idx,
+                          std::vector<PooledIOBuffer>& interm_buffers,
+                          bool use_thread_pool = true, RequestCopyTracker* tracker = nullptr);
 
   /**
-   * @brief Wait for the copies scheduled by ScheduleInputCopy or ScheduleOutputCopy
-   *        and wait for them to finish.
+   * @brief Schedule a copy of every sample of the output directly to its place in the chunks.
+   *
+   * Requires all the chunks to be on the same device, no sample to span two chunks
+   * and the chunks to be filled up completely.
+   * @return False, if the output doesn't satisfy the requirements and nothing was copied.
+   */
+  bool ScheduleOutputScatter(const ODescr& output, int output_idx);
+
+  /**
+   * @brief Wait for the outputs scheduled with PutOutputsAsync to be copied.
+   */
+  void WaitForPendingOutputs();
+
+  /**
+   * @brief Wait for the copies scheduled on the pipeline's copy stream,
+   *        e.g. by ScheduleInputCopy or StageOutputs.
    */
   void WaitForCopies();
 
+  /**
+   * @brief Wait for the copies of the outputs, e.g. scheduled by ScheduleOutputCopy.
+   *
+   * An event is recorded on each of the output streams and waited for,
+   * so the copies scheduled later on the streams are not waited for.
+   * @param use_thread_pool Wait for the copies issued from the thread pool too.
+   */
+  void WaitForOutputCopies(bool use_thread_pool = true);
+
+  /**
+   * @brief Get the stream for the copies of a given output.
+   */
+  cudaStream_t OutputStream(int output_idx) {
+    if (output_streams_.empty())
+      return pipeline_.CopyStream();
+    return output_streams_[output_idx % output_streams_.size()];
+  }
+
   /**
    * @brief Check if an input can be used without a copy.
    */
   bool IsNoCopy(const IDescr& input);
 
   int GetNumThreads() {
-    auto n_threads = pipeline_.NumThreadsArg();
+    auto n_threads =
+        options_.num_copy_threads > 0 ? options_.num_copy_threads : pipeline_.NumThreadsArg();
     return (n_threads < 1) ? 1 : n_threads;
   }
 
   /**
-   * @brief Get an intermediate buffer located on the \p device for an input with a given \p name
+   * @brief Get an intermediate buffer of a given \p size located on the \p device.
+   */
+  PooledIOBuffer AllocateBuffer(device_type_t device, size_t size);
+
+  /**
+   * @brief Reserve \p count intermediate buffers of a given \p size on the \p device.
+   *        Device buffers are not reserved, if the pipeline has no GPU.
+   *
+   * Sets reservation_exceeds_cache_, if the buffers don't fit in the limit of the cached memory.
    */
-  IOBufferI* GetInputBuffer(const std::string& name, device_type_t device);
+  void ReserveBuffers(device_type_t device, size_t size, int count);
 
   /**
-   * @brief Get an intermediate buffer located on the \p device for an output with a given \p name
+   * @brief Reserve the buffers of the outputs given by output_batch_bytes.
+   *        The devices of the outputs are known after the first run.
    */
-  IOBufferI* GetOutputBuffer(const std::string& name, device_type_t device);
+  void ReserveOutputBuffers();
 
   DaliPipeline pipeline_;
+  ExecutorOptions options_;
   ThreadPool thread_pool_;
-  std::map<std::string, IOBuffer<CPU>> cpu_buffers_;
-  std::map<std::string, IOBuffer<GPU>> gpu_buffers_;
+  std::shared_ptr<MemoryPool> host_pool_{};
+  std::shared_ptr<MemoryPool> device_pool_{};
+  MemoryPool::CacheLimit host_cache_limit_{};  // held while the executor exists
+  MemoryPool::CacheLimit device_cache_limit_{};
+  std::vector<CUDAStream> output_streams_{};
+  std::vector<CUDAEvent> output_events_{};  // one per output stream
+  std::vector<CUDAEvent> request_events_{};  // pool of RequestCopyTracker
+  std::unique_ptr<ScatterGatherGPU> device_gather_{};  // created with the first device gather
+  std::vector<PooledIOBuffer> input_buffers_{};
+  std::vector<StagedOutput> staged_outputs_{};
+  std::vector<TensorListShape<>> output_shapes_{};
+  std::vector<OutputInfo> outputs_info_{};
+  RunTimings run_timings_{};
+  std::shared_future<void> pending_outputs_{};
+  std::future<void> pending_task_{};
+  std::future<DaliPipeline> standby_{};  // being built or ready, if options_.standby_pipeline
+  bool output_buffers_reserved_ = false;
+  bool reservation_exceeds_cache_ = false;
 };
 
 }}}  // namespace triton::backend::dali
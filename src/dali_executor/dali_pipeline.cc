@@ -22,23 +22,88 @@
 
 #include "src/dali_executor/dali_pipeline.h"
 
+#include <cstdlib>
 #include <memory>
 
 namespace triton { namespace backend { namespace dali {
 
 std::once_flag DaliPipeline::dali_initialized_{};
+DaliInitOptions DaliPipeline::init_options_{};
+std::mutex DaliPipeline::preallocation_mutex_{};
+std::set<int> DaliPipeline::preallocated_devices_{};
+bool DaliPipeline::dali_init_started_ = false;
+
+
+void DaliPipeline::SetInitOptions(DaliInitOptions options) {
+  std::lock_guard<std::mutex> lock(preallocation_mutex_);
+  ENFORCE(!dali_init_started_,
+          "DALI initialization options have to be set before the first pipeline is created.");
+  init_options_ = std::move(options);
+}
+
+
+void DaliPipeline::InitDali() {
+  std::call_once(dali_initialized_, []() {
+    DaliInitOptions options;
+    {
+      std::lock_guard<std::mutex> lock(preallocation_mutex_);
+      dali_init_started_ = true;
+      options = init_options_;
+    }
+    for (auto& var : options.env) {
+      setenv(var.first.c_str(), var.second.c_str(), 0);
+    }
+    daliInitialize();
+    daliInitOperators();
+    if (options.preallocate_pinned_bytes > 0) {
+      daliPreallocatePinnedMemory(options.preallocate_pinned_bytes);
+    }
+  });
+  if (NoGpu() || init_options_.preallocate_device_bytes == 0)
+    return;
+  std::lock_guard<std::mutex> lock(preallocation_mutex_);
+  if (preallocated_devices_.insert(device_id_).second) {
+    daliPreallocateDeviceMemory(init_options_.preallocate_device_bytes, device_id_);
+  }
+}
+
+
+PipelineMemoryStats DaliPipeline::GetMemoryStats() {
+  PipelineMemoryStats stats{};
+  if (!memory_stats_)
+    return stats;
+  daliExecutorMetadata* meta = nullptr;
+  size_t num_ops = 0;
+  daliGetExecutorMetadata(&handle_, &meta, &num_ops);
+  for (size_t op = 0; op < num_ops; ++op) {
+    for (size_t out = 0; out < meta[op].out_num; ++out) {
+      stats.used_bytes += meta[op].real_size[out];
+      stats.peak_used_bytes += meta[op].max_real_size[out];
+      stats.reserved_bytes += meta[op].reserved[out];
+      stats.peak_reserved_bytes += meta[op].max_reserved[out];
+    }
+  }
+  daliFreeExecutorMetadata(meta, num_ops);
+  return stats;
+}
 
 
 TensorListShape<> DaliPipeline::GetOutputShapeAt(int output_idx) {
-  size_t batch_size = daliNumTensors(&handle_, output_idx);
-  auto ndim = daliMaxDimTensors(&handle_, output_idx);
-  TensorListShape<> result(batch_size, ndim);
-  for (size_t s = 0; s < batch_size; ++s) {
+  TensorListShape<> result;
+  GetOutputShapeAt(output_idx, result);
+  return result;
+}
+
+
+void DaliPipeline::GetOutputShapeAt(int output_idx, TensorListShape<>& result) {
+  int64_t batch_size = daliNumTensors(&handle_, output_idx);
+  int ndim = daliMaxDimTensors(&handle_, output_idx);
+  result.resize(batch_size, ndim);
+  for (int64_t s = 0; s < batch_size; ++s) {
     auto* shape = daliShapeAtSample(&handle_, output_idx, s);
     result.set_tensor_shape(s, span<int64_t>(shape, ndim));
     free(shape);
   }
-  return result;
 }
 
 
@@ -55,26 +120,28 @@ std::vector<TensorListShape<>> DaliPipeline::GetOutputShapes() {
 
 void DaliPipeline::SetInput(const void* data_ptr, const char* name, device_type_t source_device,
                             dali_data_type_t data_type, span<const int64_t> inputs_shapes,
-                            int sample_ndims) {
+                            int sample_ndims, bool no_copy) {
   ENFORCE(inputs_shapes.size() % sample_ndims == 0, "Incorrect inputs shapes or sample ndims");
   int batch_size = inputs_shapes.size() / sample_ndims;
+  unsigned int flags = no_copy ? DALI_ext_force_no_copy : DALI_ext_default;
   daliSetExternalInputBatchSize(&handle_, name, batch_size);
   daliSetExternalInput(&handle_, name, source_device, data_ptr, data_type, inputs_shapes.data(),
-                       sample_ndims, nullptr, DALI_ext_default);
+                       sample_ndims, nullptr, flags);
 }
 
 
 void DaliPipeline::SetInput(const void* ptr, const char* name, device_type_t source_device,
-                            dali_data_type_t data_type, TensorListShape<> input_shape) {
+                            dali_data_type_t data_type, TensorListShape<> input_shape,
+                            bool no_copy) {
   SetInput(ptr, name, source_device, data_type, make_span(input_shape.shapes),
-           input_shape.sample_dim());
+           input_shape.sample_dim(), no_copy);
 }
 
-void DaliPipeline::SetInput(const IDescr& io_descr) {
+void DaliPipeline::SetInput(const IDescr& io_descr, bool no_copy) {
   ENFORCE(io_descr.buffers.size() == 1, "DALI pipeline input has to be a single chunk of memory");
   auto meta = io_descr.meta;
   auto buffer = io_descr.buffers[0];
-  SetInput(buffer.data, meta.name.c_str(), buffer.device, meta.type, meta.shape);
+  SetInput(buffer.data, meta.name.c_str(), buffer.device, meta.type, meta.shape, no_copy);
 }
 
 void DaliPipeline::SyncStream() {
@@ -85,9 +152,29 @@ void DaliPipeline::SyncStream() {
 }
 
 void DaliPipeline::PutOutput(void* destination, int output_idx, device_type_t destination_device) {
+  PutOutput(destination, output_idx, destination_device, output_stream_);
+}
+
+void DaliPipeline::PutOutput(void* destination, int output_idx, device_type_t destination_device,
+                             cudaStream_t stream) {
   assert(destination != nullptr);
   assert(output_idx >= 0);
-  daliOutputCopy(&handle_, destination, output_idx, destination_device, output_stream_, 0);
+  daliOutputCopy(&handle_, destination, output_idx, destination_device, stream, 0);
+}
+
+void DaliPipeline::PutOutputSamples(std::vector<void*>& destinations, int output_idx,
+                                    device_type_t destination_device) {
+  PutOutputSamples(destinations, output_idx, destination_device, output_stream_);
+}
+
+void DaliPipeline::PutOutputSamples(std::vector<void*>& destinations, int output_idx,
+                                    device_type_t destination_device, cudaStream_t stream) {
+  assert(output_idx >= 0);
+  assert(static_cast<int64_t>(destinations.size()) == daliNumTensors(&handle_, output_idx));
+  // Scattering to the device memory is done with a single kernel instead of a copy per sample
+  unsigned int flags = destination_device == device_type_t::GPU ? DALI_use_copy_kernel : 0;
+  daliOutputCopySamples(&handle_, destinations.data(), output_idx, destination_device, stream,
+                        flags);
 }
 
 }}}  // namespace triton::backend::dali
@@ -23,8 +23,11 @@
 #ifndef DALI_BACKEND_DALI_EXECUTOR_DALI_PIPELINE_H_
 #define DALI_BACKEND_DALI_EXECUTOR_DALI_PIPELINE_H_
 
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/dali_executor/io_descriptor.h"
@@ -35,6 +38,37 @@
 
 namespace triton { namespace backend { namespace dali {
 
+/**
+ * @brief Process-wide settings of DALI, applied when the first pipeline is created.
+ */
+struct DaliInitOptions {
+  /**
+   * Device memory preallocated in DALI's pool on every device, that runs a pipeline.
+   */
+  size_t preallocate_device_bytes = 0;
+
+  /**
+   * Pinned host memory preallocated in DALI's pool.
+   */
+  size_t preallocate_pinned_bytes = 0;
+
+  /**
+   * DALI settings passed through environment variables (e.g. DALI_USE_DEVICE_MEM_POOL).
+   * Variables already present in the environment take precedence.
+   */
+  std::vector<std::pair<std::string, std::string>> env{};
+};
+
+/**
+ * @brief Memory of the outputs of the pipeline's operators, from DALI's memory statistics.
+ */
+struct PipelineMemoryStats {
+  size_t used_bytes = 0;           // by the data of the last iteration
+  size_t peak_used_bytes = 0;      // by the data of any iteration so far
+  size_t reserved_bytes = 0;       // allocated for the buffers
+  size_t peak_reserved_bytes = 0;  // allocated for the buffers at any time so far
+};
+
 class DaliPipeline {
  public:
   DaliPipeline(const DaliPipeline&) = delete;
@@ -52,9 +86,14 @@ class DaliPipeline {
       ReleasePipeline();
       ReleaseStream();
       serialized_pipeline_ = std::move(dp.serialized_pipeline_);
+      serialized_size_ = dp.serialized_size_;
       max_batch_size_ = dp.max_batch_size_;
       num_threads_ = dp.num_threads_;
       device_id_ = dp.device_id_;
+      pipelined_ = dp.pipelined_;
+      async_ = dp.async_;
+      prefetch_queue_depth_ = dp.prefetch_queue_depth_;
+      memory_stats_ = dp.memory_stats_;
       handle_ = dp.handle_;
       output_stream_ = dp.output_stream_;
 
@@ -69,24 +108,53 @@ class DaliPipeline {
     ReleaseStream();
   }
 
-  DaliPipeline(const std::string& serialized_pipeline, int max_batch_size, int num_threads,
-               int device_id) :
-      serialized_pipeline_(serialized_pipeline),
+  /**
+   * @param serialized_pipeline Serialized pipeline, shared with other pipelines.
+   *                            It's kept alive, so that the pipeline can be recreated on Reset().
+   * @param pipelined Use pipelined execution in DALI.
+   * @param async Use asynchronous execution in DALI.
+   *              Outputs of the previous iteration are kept alive until the next call to Output().
+   * @param prefetch_queue_depth Number of outputs buffered by DALI.
+   * @param memory_stats Collect the memory statistics of the operators, see GetMemoryStats().
+   */
+  DaliPipeline(std::shared_ptr<const char> serialized_pipeline, size_t serialized_size,
+               int max_batch_size, int num_threads, int device_id, bool pipelined = false,
+               bool async = false, int prefetch_queue_depth = 1, bool memory_stats = false) :
+      serialized_pipeline_(std::move(serialized_pipeline)),
+      serialized_size_(serialized_size),
       max_batch_size_(max_batch_size),
       num_threads_(num_threads),
-      device_id_(device_id) {
+      device_id_(device_id),
+      pipelined_(pipelined),
+      async_(async),
+      prefetch_queue_depth_(prefetch_queue_depth),
+      memory_stats_(memory_stats) {
+    ENFORCE(!async_ || pipelined_, "Asynchronous execution requires pipelined execution.");
+    ENFORCE(!async_ || prefetch_queue_depth_ > 1,
+            "Asynchronous execution requires the prefetch queue depth of at least 2.");
     DeviceGuard dg(device_id_);
     InitDali();
     InitStream();
     CreatePipeline();
   }
 
+  DaliPipeline(const std::string& serialized_pipeline, int max_batch_size, int num_threads,
+               int device_id, bool pipelined = false, bool async = false,
+               int prefetch_queue_depth = 1, bool memory_stats = false) :
+      DaliPipeline(ShareString(serialized_pipeline), serialized_pipeline.size(), max_batch_size,
+                   num_threads, device_id, pipelined, async, prefetch_queue_depth,
+                   memory_stats) {}
+
   void Run() {
-    daliOutputRelease(&handle_);
+    TRITON_DALI_RANGE(range, "DALI Run", TimeRange::knvGreen);
+    if (!async_) {
+      daliOutputRelease(&handle_);
+    }
     daliRun(&handle_);
   }
 
   void Output() {
+    TRITON_DALI_RANGE(range, "DALI Output", TimeRange::kGreen1);
     daliOutput(&handle_);
   }
 
@@ -100,6 +168,14 @@ class DaliPipeline {
 
   TensorListShape<> GetOutputShapeAt(int output_idx);
 
+  /**
+   * @brief Get the shape of an output, reusing the memory of \p result.
+   *
+   * DALI is queried for the shape of each sample separately. The C API has no query telling
+   * whether the samples are uniform and the shapes in the config can't prove it.
+   */
+  void GetOutputShapeAt(int output_idx, TensorListShape<>& result);
+
   size_t GetOutputNumElements(int output_idx) {
     return daliNumElements(&handle_, output_idx);
   }
@@ -114,16 +190,40 @@ class DaliPipeline {
 
   std::vector<TensorListShape<>> GetOutputShapes();
 
+  /**
+   * @param no_copy If true, DALI uses the data in place, instead of copying it.
+   *                The data has to stay valid until the iteration that consumes it is finished.
+   */
   void SetInput(const void* data_ptr, const char* name, device_type_t source_device,
-                dali_data_type_t data_type, span<const int64_t> inputs_shapes, int sample_ndims);
+                dali_data_type_t data_type, span<const int64_t> inputs_shapes, int sample_ndims,
+                bool no_copy = false);
 
   void SetInput(const void* ptr, const char* name, device_type_t source_device,
-                dali_data_type_t data_type, TensorListShape<> input_shape);
+                dali_data_type_t data_type, TensorListShape<> input_shape, bool no_copy = false);
 
-  void SetInput(const IDescr& io_descr);
+  void SetInput(const IDescr& io_descr, bool no_copy = false);
 
   void PutOutput(void* destination, int output_idx, device_type_t destination_device);
 
+  /**
+   * @brief Copy the output on a given \p stream, instead of the copy stream.
+   */
+  void PutOutput(void* destination, int output_idx, device_type_t destination_device,
+                 cudaStream_t stream);
+
+  /**
+   * @brief Copy each sample of the output to its own destination.
+   * @param destinations Destination of every sample of the output.
+   */
+  void PutOutputSamples(std::vector<void*>& destinations, int output_idx,
+                        device_type_t destination_device);
+
+  /**
+   * @brief Copy the samples on a given \p stream, instead of the copy stream.
+   */
+  void PutOutputSamples(std::vector<void*>& destinations, int output_idx,
+                        device_type_t destination_device, cudaStream_t stream);
+
   /**
    * @brief Wait for the work scheduled on the copy stream.
    *
@@ -140,6 +240,14 @@ class DaliPipeline {
     CreatePipeline();
   }
 
+  /**
+   * @brief Create another pipeline from the same serialized pipeline, with the same arguments.
+   */
+  DaliPipeline Clone() const {
+    return DaliPipeline(serialized_pipeline_, serialized_size_, max_batch_size_, num_threads_,
+                        device_id_, pipelined_, async_, prefetch_queue_depth_, memory_stats_);
+  }
+
 
   int DeviceId() const {
     return device_id_;
@@ -151,6 +259,44 @@ class DaliPipeline {
   }
 
 
+  int MaxBatchSize() const {
+    return max_batch_size_;
+  }
+
+
+  bool IsAsync() const {
+    return async_;
+  }
+
+  bool HasMemoryStats() const {
+    return memory_stats_;
+  }
+
+  /**
+   * @brief Get the memory of the outputs of all the operators, CPU and GPU ones.
+   *
+   * All zeros, unless the pipeline is created with the memory statistics enabled.
+   */
+  PipelineMemoryStats GetMemoryStats();
+
+  /**
+   * @brief Preallocate device memory in DALI's pool on the device of the pipeline.
+   *
+   * Does nothing for a pipeline without a GPU.
+   */
+  void PreallocateDeviceMemory(size_t bytes) {
+    if (!NoGpu() && bytes > 0)
+      daliPreallocateDeviceMemory(bytes, device_id_);
+  }
+
+  /**
+   * @brief Set the options of DALI initialization.
+   *
+   * Has to be called before the first pipeline is created.
+   */
+  static void SetInitOptions(DaliInitOptions options);
+
+
  private:
   /**
    * @return True, if this DALI Pipeline does not have GPU available
@@ -159,9 +305,16 @@ class DaliPipeline {
     return device_id_ < 0;
   }
 
+  static std::shared_ptr<const char> ShareString(const std::string& str) {
+    auto shared = std::make_shared<std::string>(str);
+    return std::shared_ptr<const char>(shared, shared->data());
+  }
+
   void CreatePipeline() {
-    daliCreatePipeline(&handle_, serialized_pipeline_.c_str(), serialized_pipeline_.length(),
-                       max_batch_size_, num_threads_, device_id_, 0, 1, 0, 0, 0);
+    daliCreatePipeline2(&handle_, serialized_pipeline_.get(), serialized_size_,
+                        max_batch_size_, num_threads_, device_id_, pipelined_, async_, 0,
+                        prefetch_queue_depth_, prefetch_queue_depth_, prefetch_queue_depth_,
+                        memory_stats_);
     assert(handle_.pipe != nullptr && handle_.ws != nullptr);
   }
 
@@ -181,12 +334,11 @@ class DaliPipeline {
     }
   }
 
-  void InitDali() {
-    std::call_once(dali_initialized_, []() {
-      daliInitialize();
-      daliInitOperators();
-    });
-  }
+  /**
+   * @brief Initialize DALI, once per process, and preallocate the memory on the
+   *        pipeline's device, once per device.
+   */
+  void InitDali();
 
   void InitStream() {
     if (NoGpu())
@@ -194,14 +346,23 @@ class DaliPipeline {
     CUDA_CALL_GUARD(cudaStreamCreate(&output_stream_));
   }
 
-  std::string serialized_pipeline_{};
+  std::shared_ptr<const char> serialized_pipeline_{};
+  size_t serialized_size_ = 0;
   int max_batch_size_ = 0;
   int num_threads_ = 0;
   int device_id_ = 0;
+  bool pipelined_ = false;
+  bool async_ = false;
+  int prefetch_queue_depth_ = 1;
+  bool memory_stats_ = false;
 
   daliPipelineHandle handle_{};
   ::cudaStream_t output_stream_ = nullptr;
   static std::once_flag dali_initialized_;
+  static DaliInitOptions init_options_;
+  static std::mutex preallocation_mutex_;
+  static std::set<int> preallocated_devices_;
+  static bool dali_init_started_;
 };
 
 
@@ -0,0 +1,199 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/dali_executor/dali_executor.h"
+#include "src/dali_executor/test/test_utils.h"
+#include "src/dali_executor/test_data.h"
+
+/**
+ * Benchmarks of the executor level only: DaliExecutor::Run and PutOutputs with the inputs and
+ * outputs laid out like the backend lays them out. Gathering the inputs from the Triton requests
+ * (GenerateInputs) and allocating the responses (AllocateOutputs) need the server's handles
+ * and are not covered.
+ */
+
+namespace triton { namespace backend { namespace dali { namespace bench {
+
+using test::RandomInput;
+
+constexpr int kMaxBatchSize = 256;
+
+/**
+ * @brief The scale pipeline, consuming the input on a given device.
+ */
+DaliPipeline ScalePipeline(device_type_t input_device = device_type_t::CPU) {
+  bool gpu = input_device == device_type_t::GPU;
+  std::string pipeline_s(
+      (const char *)(gpu ? test::pipelines::scale_gpu_pipeline_str
+                         : test::pipelines::scale_pipeline_str),
+      gpu ? test::pipelines::scale_gpu_pipeline_len : test::pipelines::scale_pipeline_len);
+  return DaliPipeline(pipeline_s, kMaxBatchSize, 4, 0);
+}
+
+/**
+ * @brief Batch sizes of the requests, which a batch is gathered from.
+ */
+std::vector<int> SplitBatch(int batch_size, int num_requests) {
+  std::vector<int> batch_sizes(num_requests, batch_size / num_requests);
+  for (int i = 0; i < batch_size % num_requests; ++i) {
+    batch_sizes[i]++;
+  }
+  return batch_sizes;
+}
+
+/**
+ * @brief Input of the scale pipeline, in one chunk per request, like the inputs
+ *        gathered from the requests by the backend.
+ */
+IDescr ScaleInput(const std::vector<int> &batch_sizes, device_type_t device,
+                  std::vector<std::vector<float>> &host_buffers,
+                  std::vector<std::unique_ptr<IOBufferI>> &device_buffers) {
+  std::mt19937 rand(1217);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<TensorListShape<>> shapes;
+  for (auto batch_size : batch_sizes) {
+    TensorListShape<> shape(batch_size, 2);
+    for (int i = 0; i < batch_size; ++i) {
+      shape.set_tensor_shape(i, TensorShape<>((i % 8 + 1) * 8, 1024));
+    }
+    shapes.push_back(shape);
+  }
+  auto input = RandomInput(host_buffers, "INPUT0", shapes, [&]() { return dist(rand); });
+  if (device == device_type_t::GPU) {
+    for (auto &buffer : input.buffers) {
+      device_buffers.emplace_back(std::make_unique<IOBuffer<GPU>>(buffer.size));
+      auto descr = device_buffers.back()->get_descr();
+      MemCopy(GPU, descr.data, CPU, buffer.data, buffer.size);
+      buffer = descr;
+    }
+  }
+  return input;
+}
+
+/**
+ * @brief Output buffers, one per request, like the responses allocated by the backend.
+ */
+std::vector<ODescr> ScaleOutputs(const OutputInfo &output, const std::vector<int> &batch_sizes,
+                                 device_type_t device,
+                                 std::vector<std::unique_ptr<IOBufferI>> &buffers) {
+  std::vector<ODescr> outputs(1);
+  int64_t sample_idx = 0;
+  for (auto batch_size : batch_sizes) {
+    int64_t size = 0;
+    for (int i = 0; i < batch_size; ++i) {
+      size += volume(output.shape[sample_idx++]) * sizeof(float);
+    }
+    if (device == device_type_t::CPU) {
+      buffers.emplace_back(std::make_unique<IOBuffer<CPU>>(size));
+    } else {
+      buffers.emplace_back(std::make_unique<IOBuffer<GPU>>(size));
+    }
+    outputs[0].buffers.push_back(buffers.back()->get_descr());
+  }
+  return outputs;
+}
+
+/**
+ * Run and PutOutputs of the scale pipeline, i.e. the path of a batch between gathering
+ * the requests and sending the responses. Arguments: batch size, number of requests
+ * (chunks of the input and output), input device and output device (0 - CPU, 1 - GPU).
+ * GPU inputs go to the variant of the pipeline, which consumes them on the GPU.
+ */
+void BM_RunAndPutOutputs(benchmark::State &state) {
+  int batch_size = state.range(0);
+  auto batch_sizes = SplitBatch(batch_size, state.range(1));
+  auto input_device = state.range(2) ? device_type_t::GPU : device_type_t::CPU;
+  auto output_device = state.range(3) ? device_type_t::GPU : device_type_t::CPU;
+  DaliExecutor executor(ScalePipeline(input_device));
+  std::vector<std::vector<float>> host_buffers;
+  std::vector<std::unique_ptr<IOBufferI>> input_buffers, output_buffers;
+  std::vector<IDescr> inputs = {
+      ScaleInput(batch_sizes, input_device, host_buffers, input_buffers)};
+  auto outputs = ScaleOutputs(executor.Run(inputs)[0], batch_sizes, output_device,
+                              output_buffers);
+  executor.PutOutputs(outputs);
+  for (auto _ : state) {
+    executor.Run(inputs);
+    executor.PutOutputs(outputs);
+  }
+  int64_t bytes = inputs[0].meta.shape.num_elements() * sizeof(float);
+  state.SetItemsProcessed(state.iterations() * batch_size);
+  state.SetBytesProcessed(state.iterations() * bytes * 2);  // in and out
+}
+
+/**
+ * Run alone, including the gather of the input chunks and the output shape queries.
+ * Arguments: batch size, number of requests, input device.
+ */
+void BM_Run(benchmark::State &state) {
+  int batch_size = state.range(0);
+  auto batch_sizes = SplitBatch(batch_size, state.range(1));
+  auto input_device = state.range(2) ? device_type_t::GPU : device_type_t::CPU;
+  DaliExecutor executor(ScalePipeline(input_device));
+  std::vector<std::vector<float>> host_buffers;
+  std::vector<std::unique_ptr<IOBufferI>> input_buffers;
+  std::vector<IDescr> inputs = {
+      ScaleInput(batch_sizes, input_device, host_buffers, input_buffers)};
+  executor.Run(inputs);
+  for (auto _ : state) {
+    executor.Run(inputs);
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+void ExecutorArgs(benchmark::internal::Benchmark *b, bool with_output_device) {
+  for (int64_t batch_size : {1, 64, 256}) {
+    for (int64_t num_requests : {1, 8, 64}) {
+      if (num_requests > batch_size)
+        continue;
+      for (int64_t input_device : {0, 1}) {
+        if (!with_output_device) {
+          b->Args({batch_size, num_requests, input_device});
+          continue;
+        }
+        for (int64_t output_device : {0, 1}) {
+          b->Args({batch_size, num_requests, input_device, output_device});
+        }
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_RunAndPutOutputs)
+    ->Apply([](benchmark::internal::Benchmark *b) { ExecutorArgs(b, true); })
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_Run)
+    ->Apply([](benchmark::internal::Benchmark *b) { ExecutorArgs(b, false); })
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}}}}  // namespace triton::backend::dali::bench
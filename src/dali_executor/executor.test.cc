@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include <algorithm>
+#include <numeric>
 #include <catch2/catch.hpp>
 
 #include "src/dali_executor/dali_executor.h"
@@ -58,71 +59,203 @@ void coalesced_compare(const std::vector<OBufferDescr> &obuffers,
   }
 }
 
-TEST_CASE("Scaling Pipeline") {
-  std::string pipeline_s((const char *)pipelines::scale_pipeline_str,
-                         pipelines::scale_pipeline_len);
-  DaliPipeline pipeline(pipeline_s, 256, 4, 0);
-  DaliExecutor executor(std::move(pipeline));
-  std::mt19937 rand(1217);
+void scaling_shapes_test(DaliExecutor &executor, std::mt19937 &rand,
+                         const std::vector<TensorListShape<>> &shapes,
+                         const std::vector<int> &out_batch_sizes,
+                         const std::vector<device_type_t> &out_devs, bool per_request = false,
+                         device_type_t inp_dev = device_type_t::CPU) {
   std::uniform_real_distribution<float> dist(-1.f, 1.f);
   const std::string inp_name = "INPUT0";
-  auto scaling_test = [&](const std::vector<int> &batch_sizes,
-                          const std::vector<int> &out_batch_sizes,
-                          const std::vector<device_type_t> &out_devs) {
-    REQUIRE(std::accumulate(batch_sizes.begin(), batch_sizes.end(), 0) ==
-            std::accumulate(out_batch_sizes.begin(), out_batch_sizes.end(), 0));
-    REQUIRE(out_devs.size() == out_batch_sizes.size());
-    std::vector<TensorListShape<>> shapes;
-    for (auto batch_size : batch_sizes) {
-      TensorListShape<> shape(batch_size, 2);
-      for (int i = 0; i < batch_size; ++i) {
-        shape.set_tensor_shape(i, TensorShape<>(i + 1, 50));
-      }
-      shapes.push_back(shape);
+  int num_samples = 0;
+  for (auto &shape : shapes)
+    num_samples += shape.num_samples();
+  REQUIRE(num_samples == std::accumulate(out_batch_sizes.begin(), out_batch_sizes.end(), 0));
+  REQUIRE(out_devs.size() == out_batch_sizes.size());
+  std::vector<std::vector<float>> input_buffers;
+  auto input = RandomInput(input_buffers, inp_name, shapes, [&]() { return dist(rand); });
+  std::vector<std::unique_ptr<IOBufferI>> device_input_buffers;
+  if (inp_dev == device_type_t::GPU) {
+    for (auto &buffer : input.buffers) {
+      device_input_buffers.emplace_back(std::make_unique<IOBuffer<GPU>>(buffer.size));
+      auto descr = device_input_buffers.back()->get_descr();
+      MemCopy(GPU, descr.data, CPU, buffer.data, buffer.size);
+      buffer = descr;
     }
-    std::vector<std::vector<float>> input_buffers;
-    auto input = RandomInput(input_buffers, inp_name, shapes, [&]() { return dist(rand); });
-    auto output = executor.Run({input});
-    REQUIRE(cat_list_shapes(shapes) == output[0].shape);
-    size_t inp_size = 0;
-    for (auto &inp_buffer : input_buffers)
-      inp_size += inp_buffer.size();
-    std::vector<std::unique_ptr<IOBufferI>> output_buffers;
-    int ti = 0;
-    for (size_t out_i = 0; out_i < out_batch_sizes.size(); ++out_i) {
-      int64_t buffer_vol = 0;
-      for (int i = 0; i < out_batch_sizes[out_i]; ++i) {
-        buffer_vol += volume(output[0].shape[ti]) * sizeof(float);
-        ti++;
-      }
-      if (out_devs[out_i] == device_type_t::CPU) {
-        output_buffers.emplace_back(std::make_unique<IOBuffer<CPU>>(buffer_vol));
-      } else {
-        output_buffers.emplace_back(std::make_unique<IOBuffer<GPU>>(buffer_vol));
-      }
+  }
+  auto output = executor.Run({input});
+  REQUIRE(cat_list_shapes(shapes) == output[0].shape);
+  size_t inp_size = 0;
+  for (auto &inp_buffer : input_buffers)
+    inp_size += inp_buffer.size();
+  std::vector<std::unique_ptr<IOBufferI>> output_buffers;
+  int ti = 0;
+  for (size_t out_i = 0; out_i < out_batch_sizes.size(); ++out_i) {
+    int64_t buffer_vol = 0;
+    for (int i = 0; i < out_batch_sizes[out_i]; ++i) {
+      buffer_vol += volume(output[0].shape[ti]) * sizeof(float);
+      ti++;
     }
-    std::vector<ODescr> output_vec(1);
-    auto &outdesc = output_vec[0];
-    for (auto &out_buffer : output_buffers) {
-      outdesc.buffers.push_back(out_buffer->get_descr());
+    if (out_devs[out_i] == device_type_t::CPU) {
+      output_buffers.emplace_back(std::make_unique<IOBuffer<CPU>>(buffer_vol));
+    } else {
+      output_buffers.emplace_back(std::make_unique<IOBuffer<GPU>>(buffer_vol));
     }
+  }
+  std::vector<ODescr> output_vec(1);
+  auto &outdesc = output_vec[0];
+  for (auto &out_buffer : output_buffers) {
+    outdesc.buffers.push_back(out_buffer->get_descr());
+  }
+  if (per_request) {
+    std::vector<int> copied;
+    executor.PutOutputs(output_vec, [&](int request_idx) { copied.push_back(request_idx); });
+    std::vector<int> expected(out_batch_sizes.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(copied == expected);
+  } else {
     executor.PutOutputs(output_vec);
-    coalesced_compare(outdesc.buffers, input_buffers, inp_size, [](float a) { return a * 2; });
-  };
+  }
+  coalesced_compare(outdesc.buffers, input_buffers, inp_size, [](float a) { return a * 2; });
+}
+
+void scaling_test(DaliExecutor &executor, std::mt19937 &rand,
+                  const std::vector<int> &batch_sizes, const std::vector<int> &out_batch_sizes,
+                  const std::vector<device_type_t> &out_devs, bool per_request = false,
+                  device_type_t inp_dev = device_type_t::CPU) {
+  std::vector<TensorListShape<>> shapes;
+  for (auto batch_size : batch_sizes) {
+    TensorListShape<> shape(batch_size, 2);
+    for (int i = 0; i < batch_size; ++i) {
+      shape.set_tensor_shape(i, TensorShape<>(i + 1, 50));
+    }
+    shapes.push_back(shape);
+  }
+  scaling_shapes_test(executor, rand, shapes, out_batch_sizes, out_devs, per_request, inp_dev);
+}
+
+TEST_CASE("Scaling Pipeline") {
+  std::string pipeline_s((const char *)pipelines::scale_pipeline_str,
+                         pipelines::scale_pipeline_len);
+  DaliPipeline pipeline(pipeline_s, 256, 4, 0);
+  DaliExecutor executor(std::move(pipeline));
+  std::mt19937 rand(1217);
+
+  SECTION("Simple execute") {
+    scaling_test(executor, rand, {3, 2, 1}, {6}, {CPU});
+    scaling_test(executor, rand, {5}, {5}, {GPU});
+  }
+
+  SECTION("Chunked output") {
+    scaling_test(executor, rand, {3, 3}, {3, 3}, {CPU, CPU});
+    scaling_test(executor, rand, {6}, {2, 4}, {GPU, GPU});
+    scaling_test(executor, rand, {8}, {6, 2}, {CPU, GPU});
+    scaling_test(executor, rand, {64}, {32, 16, 16}, {CPU, GPU, GPU});
+  }
+
+  SECTION("Many small requests") {
+    std::vector<int> requests(64, 1);
+    scaling_test(executor, rand, requests, {64}, {CPU});
+    scaling_test(executor, rand, requests, {32, 32}, {GPU, CPU});
+    scaling_test(executor, rand, requests, {32, 32}, {CPU, GPU}, true);
+  }
+
+  SECTION("Per-request completion") {
+    scaling_test(executor, rand, {5}, {5}, {GPU}, true);
+    scaling_test(executor, rand, {8}, {6, 2}, {CPU, GPU}, true);
+    scaling_test(executor, rand, {6}, {1, 1, 4}, {GPU, GPU, GPU}, true);
+  }
+}
+
+TEST_CASE("Scaling Pipeline with GPU inputs") {
+  std::string pipeline_s((const char *)pipelines::scale_gpu_pipeline_str,
+                         pipelines::scale_gpu_pipeline_len);
+  DaliPipeline pipeline(pipeline_s, 256, 4, 0);
+  DaliExecutor executor(std::move(pipeline));
+  std::mt19937 rand(1217);
+
+  SECTION("Single chunk") {
+    scaling_test(executor, rand, {5}, {5}, {CPU}, false, GPU);
+  }
+
+  SECTION("Chunks gathered on the device") {
+    scaling_test(executor, rand, {3, 2, 1}, {6}, {CPU}, false, GPU);
+    scaling_test(executor, rand, {8, 1, 7}, {6, 10}, {GPU, CPU}, false, GPU);
+  }
+
+  SECTION("Many small requests") {
+    std::vector<int> requests(64, 1);
+    scaling_test(executor, rand, requests, {64}, {CPU}, false, GPU);
+    scaling_test(executor, rand, requests, {32, 32}, {GPU, CPU}, false, GPU);
+  }
+}
+
+TEST_CASE("Scaling Pipeline with samples of the same total size") {
+  std::string pipeline_s((const char *)pipelines::scale_pipeline_str,
+                         pipelines::scale_pipeline_len);
+  DaliPipeline pipeline(pipeline_s, 256, 4, 0);
+  DaliExecutor executor(std::move(pipeline));
+  std::mt19937 rand(1217);
+  // As many elements as 4 samples of 2x50, with the first and the last sample of 2x50 too
+  TensorListShape<> shape(4, 2);
+  shape.set_tensor_shape(0, TensorShape<>(2, 50));
+  shape.set_tensor_shape(1, TensorShape<>(3, 50));
+  shape.set_tensor_shape(2, TensorShape<>(1, 50));
+  shape.set_tensor_shape(3, TensorShape<>(2, 50));
+  scaling_shapes_test(executor, rand, {shape}, {4}, {CPU});
+  scaling_shapes_test(executor, rand, {shape}, {1, 1, 1, 1}, {GPU, CPU, CPU, GPU});
+  scaling_shapes_test(executor, rand, {shape}, {2, 2}, {CPU, GPU}, true);
+}
+
+TEST_CASE("Scaling Pipeline in micro-batches") {
+  std::string pipeline_s((const char *)pipelines::scale_pipeline_str,
+                         pipelines::scale_pipeline_len);
+  DaliPipeline pipeline(pipeline_s, 8, 4, 0);
+  ExecutorOptions options{};
+  options.micro_batch_size = 3;
+  DaliExecutor executor(std::move(pipeline), options);
+  std::mt19937 rand(1217);
 
   SECTION("Simple execute") {
-    scaling_test({3, 2, 1}, {6}, {CPU});
-    scaling_test({5}, {5}, {GPU});
+    scaling_test(executor, rand, {3, 2, 1}, {6}, {CPU});
+    scaling_test(executor, rand, {7}, {7}, {GPU});
+    scaling_test(executor, rand, {2}, {2}, {CPU});
   }
 
   SECTION("Chunked output") {
-    scaling_test({3, 3}, {3, 3}, {CPU, CPU});
-    scaling_test({6}, {2, 4}, {GPU, GPU});
-    scaling_test({8}, {6, 2}, {CPU, GPU});
-    scaling_test({64}, {32, 16, 16}, {CPU, GPU, GPU});
+    scaling_test(executor, rand, {4, 4}, {5, 3}, {CPU, GPU});
+    scaling_test(executor, rand, {6}, {1, 1, 4}, {GPU, CPU, GPU});
+  }
+
+  SECTION("Batch over the pipeline limit") {
+    scaling_test(executor, rand, {12, 8}, {10, 10}, {GPU, CPU});
+  }
+
+  SECTION("Per-request completion") {
+    scaling_test(executor, rand, {4, 4}, {5, 3}, {CPU, GPU}, true);
   }
 }
 
+TEST_CASE("Warm-up") {
+  std::string pipeline_s((const char *)pipelines::scale_pipeline_str,
+                         pipelines::scale_pipeline_len);
+  DaliPipeline pipeline(pipeline_s, 8, 4, 0);
+  DaliExecutor executor(std::move(pipeline));
+  std::mt19937 rand(1217);
+  std::vector<float> sample_data(2 * 50, 1.f);
+  IDescr sample;
+  sample.meta.name = "INPUT0";
+  sample.meta.type = dali_data_type_t::DALI_FLOAT;
+  sample.meta.shape = TensorListShape<>::make_uniform(1, TensorShape<>(2, 50));
+  IBufferDescr buffer;
+  buffer.data = sample_data.data();
+  buffer.size = sample_data.size() * sizeof(float);
+  buffer.device = device_type_t::CPU;
+  sample.buffers = {buffer};
+
+  REQUIRE_NOTHROW(executor.WarmUp({sample}, {1, 8}));
+  scaling_test(executor, rand, {3, 2}, {5}, {CPU});
+}
+
 TEST_CASE("RN50 pipeline") {
   std::string pipeline_s((const char *)pipelines::rn50_gpu_dali_chr, pipelines::rn50_gpu_dali_len);
   DaliPipeline pipeline(pipeline_s, 1, 3, 0);
@@ -182,4 +315,57 @@ TEST_CASE("RN50 pipeline") {
   }
 }
 
+TEST_CASE("RN50 pipeline with a standby") {
+  std::string pipeline_s((const char *)pipelines::rn50_gpu_dali_chr, pipelines::rn50_gpu_dali_len);
+  DaliPipeline pipeline(pipeline_s, 1, 3, 0);
+  ExecutorOptions options{};
+  options.standby_pipeline = true;
+  DaliExecutor executor(std::move(pipeline), options);
+  IDescr input;
+  input.meta.name = "DALI_INPUT_0";
+  input.meta.type = dali_data_type_t::DALI_UINT8;
+  input.meta.shape = TensorListShape<1>(1);
+  input.meta.shape.set_tensor_shape(0, TensorShape<>(data::jpeg_image_len));
+  IBufferDescr ibuffer;
+  ibuffer.data = data::jpeg_image_str;
+  ibuffer.size = data::jpeg_image_len;
+  ibuffer.device = device_type_t::CPU;
+  input.buffers = {ibuffer};
+
+  auto rand_inp_shape = TensorListShape<1>(1);
+  rand_inp_shape.set_tensor_shape(0, TensorShape<>(1024));
+  std::vector<std::vector<uint8_t>> rand_input_buffer;
+  std::mt19937 rand(1217);
+  std::uniform_int_distribution<short> dist(0, 255);
+  auto gen = [&]() {
+    return dist(rand);
+  };
+  auto rand_input = RandomInput(rand_input_buffer, input.meta.name, {rand_inp_shape}, gen);
+
+  auto execute_with_image = [&]() {
+    const float expected_values[] = {-2.1179, -2.03571, -1.80444};  // 0 values after normalization
+    const int output_c = 3, output_h = 224, output_w = 224;
+    auto output = executor.Run(std::vector<IDescr>({input}));
+    REQUIRE(output[0].shape.tensor_shape(0) == TensorShape<3>(output_c, output_h, output_w));
+    std::vector<float> output_buffer(output[0].shape.num_elements());
+    std::vector<ODescr> output_vec(1);
+    OBufferDescr obuffer;
+    obuffer.device = device_type_t::CPU;
+    obuffer.device_id = 0;
+    obuffer.data = output_buffer.data();
+    obuffer.size = output_buffer.size() * sizeof(decltype(output_buffer)::value_type);
+    output_vec[0].buffers = {obuffer};
+    executor.PutOutputs(output_vec);
+    REQUIRE(output_buffer[0] == Approx(expected_values[0]));
+    REQUIRE(output_buffer.back() == Approx(expected_values[output_c - 1]));
+  };
+
+  // The first failure comes right away, possibly while the standby is still being built,
+  // the second one swaps back the pipeline rebuilt after the first one
+  for (int i = 0; i < 2; ++i) {
+    REQUIRE_THROWS(executor.Run(std::vector<IDescr>({rand_input})));
+    REQUIRE_NOTHROW(execute_with_image());
+  }
+}
+
 }}}}  // namespace triton::backend::dali::test
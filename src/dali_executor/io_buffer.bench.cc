@@ -0,0 +1,155 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "src/dali_executor/io_buffer.h"
+#include "src/dali_executor/memory_pool.h"
+#include "src/dali_executor/utils/dali.h"
+#include "src/dali_executor/utils/utils.h"
+
+namespace triton { namespace backend { namespace dali { namespace bench {
+
+const char *KindName(MemoryKind kind) {
+  switch (kind) {
+    case MemoryKind::Host:
+      return "pageable";
+    case MemoryKind::Pinned:
+      return "pinned";
+    default:
+      return "device";
+  }
+}
+
+/**
+ * MemCopy between the kinds of memory. Arguments: source kind, destination kind, size.
+ */
+void BM_MemCopy(benchmark::State &state) {
+  auto src_kind = static_cast<MemoryKind>(state.range(0));
+  auto dst_kind = static_cast<MemoryKind>(state.range(1));
+  size_t size = state.range(2);
+  PooledIOBuffer src(MemoryPool::Get(src_kind, 0), size);
+  PooledIOBuffer dst(MemoryPool::Get(dst_kind, 0), size);
+  auto src_descr = src.get_descr();
+  auto dst_descr = dst.get_descr();
+  auto stream = CUDAStream::Create(true, 0);
+  for (auto _ : state) {
+    MemCopy(dst_descr.device, dst_descr.data, src_descr.device, src_descr.data, size, stream);
+    CUDA_CALL_GUARD(cudaStreamSynchronize(stream));
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+  state.SetLabel(make_string(KindName(src_kind), " -> ", KindName(dst_kind)));
+}
+
+void MemCopyArgs(benchmark::internal::Benchmark *b) {
+  const std::vector<MemoryKind> kinds = {MemoryKind::Host, MemoryKind::Pinned, MemoryKind::Device};
+  for (auto src : kinds) {
+    for (auto dst : kinds) {
+      for (int64_t size : {64 << 10, 4 << 20, 64 << 20}) {
+        b->Args({static_cast<int64_t>(src), static_cast<int64_t>(dst), size});
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_MemCopy)->Apply(MemCopyArgs)->UseRealTime();
+
+
+/**
+ * Shapes of a batch of image-like samples of varying height.
+ */
+TensorListShape<> BatchShape(int batch_size) {
+  TensorListShape<> shape(batch_size, 3);
+  for (int i = 0; i < batch_size; ++i) {
+    shape.set_tensor_shape(i, TensorShape<>(400 + i % 16 * 10, 640, 3));
+  }
+  return shape;
+}
+
+/**
+ * cat_list_shapes of the shapes of the requests. Arguments: number of requests, batch size
+ * of each request.
+ */
+void BM_CatListShapes(benchmark::State &state) {
+  int num_requests = state.range(0);
+  int request_batch_size = state.range(1);
+  std::vector<TensorListShape<>> shapes(num_requests, BatchShape(request_batch_size));
+  for (auto _ : state) {
+    auto result = cat_list_shapes(shapes);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * num_requests * request_batch_size);
+}
+
+BENCHMARK(BM_CatListShapes)->Args({1, 256})->Args({16, 16})->Args({256, 1});
+
+/**
+ * split_list_shape of a batch into the requests. Arguments: number of requests, batch size
+ * of each request.
+ */
+void BM_SplitListShape(benchmark::State &state) {
+  int num_requests = state.range(0);
+  int request_batch_size = state.range(1);
+  auto shape = BatchShape(num_requests * request_batch_size);
+  std::vector<int> batch_sizes(num_requests, request_batch_size);
+  for (auto _ : state) {
+    auto result = split_list_shape(shape, batch_sizes);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * num_requests * request_batch_size);
+}
+
+BENCHMARK(BM_SplitListShape)->Args({1, 256})->Args({16, 16})->Args({256, 1});
+
+/**
+ * UnpackBytes of a BYTES input. Arguments: number of elements, size of an element.
+ */
+void BM_UnpackBytes(benchmark::State &state) {
+  int num_elements = state.range(0);
+  uint32_t element_size = state.range(1);
+  std::vector<uint8_t> serialized;
+  for (int i = 0; i < num_elements; ++i) {
+    for (int b = 0; b < 4; ++b) {
+      serialized.push_back((element_size >> (8 * b)) & 0xFF);
+    }
+    serialized.resize(serialized.size() + element_size);
+  }
+  IBufferDescr buffer;
+  buffer.device = device_type_t::CPU;
+  buffer.data = serialized.data();
+  buffer.size = serialized.size();
+  std::vector<IBufferDescr> buffers = {buffer}, samples;
+  for (auto _ : state) {
+    samples.clear();
+    auto shape = UnpackBytes(buffers, num_elements, samples);
+    benchmark::DoNotOptimize(shape);
+  }
+  state.SetItemsProcessed(state.iterations() * num_elements);
+}
+
+BENCHMARK(BM_UnpackBytes)->Args({1, 1 << 20})->Args({256, 100 << 10});
+
+}}}}  // namespace triton::backend::dali::bench
@@ -22,6 +22,9 @@
 
 #include "src/dali_executor/io_buffer.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace triton { namespace backend { namespace dali {
 
 void MemCopy(device_type_t dst_dev, void *dst, device_type_t src_dev, const void *src, size_t size,
@@ -39,4 +42,96 @@ void MemCopy(device_type_t dst_dev, void *dst, device_type_t src_dev, const void
   }
 }
 
+TensorListShape<> UnpackBytes(const std::vector<IBufferDescr> &buffers, int num_samples,
+                              std::vector<IBufferDescr> &samples) {
+  TensorListShape<> shape(num_samples, 1);
+  int sample_idx = 0;
+  for (auto &buffer : buffers) {
+    ENFORCE(buffer.device == device_type_t::CPU, "Serialized BYTES input has to be on the CPU.");
+    auto data = reinterpret_cast<const uint8_t *>(buffer.data);
+    size_t offset = 0;
+    while (offset < buffer.size) {
+      ENFORCE(sample_idx < num_samples, make_string("BYTES input has more than ", num_samples,
+                                                    " elements."));
+      ENFORCE(offset + sizeof(uint32_t) <= buffer.size,
+              "Truncated length of an element in BYTES input.");
+      uint32_t len = data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) |
+                     (static_cast<uint32_t>(data[offset + 3]) << 24);
+      offset += sizeof(uint32_t);
+      ENFORCE(offset + len <= buffer.size, "Truncated element in BYTES input.");
+      if (len > 0) {
+        IBufferDescr sample;
+        sample.device = buffer.device;
+        sample.device_id = buffer.device_id;
+        sample.data = data + offset;
+        sample.size = len;
+        samples.push_back(sample);
+      }
+      shape.set_tensor_shape(sample_idx++, TensorShape<1>(len));
+      offset += len;
+    }
+  }
+  ENFORCE(sample_idx == num_samples,
+          make_string("Expected ", num_samples, " elements in BYTES input, got ", sample_idx, "."));
+  return shape;
+}
+
+bool HasImageSignature(const uint8_t *head, size_t size) {
+  auto starts_with = [&](const char *signature, size_t len, size_t offset = 0) {
+    return size >= offset + len && std::memcmp(head + offset, signature, len) == 0;
+  };
+  if (starts_with("\xFF\xD8", 2))  // JPEG
+    return true;
+  if (starts_with("\x89PNG\r\n\x1A\n", 8))
+    return true;
+  if (starts_with("BM", 2))
+    return true;
+  if (starts_with("II*\0", 4) || starts_with("MM\0*", 4))  // TIFF
+    return true;
+  if (starts_with("\0\0\0\x0CjP  ", 8) || starts_with("\xFF\x4F\xFF\x51", 4))  // JPEG 2000
+    return true;
+  if (starts_with("RIFF", 4) && starts_with("WEBP", 4, 8))
+    return true;
+  return size >= 2 && head[0] == 'P' && head[1] >= '1' && head[1] <= '6';  // PNM
+}
+
+void CheckEncodedImages(const IDescr &input) {
+  constexpr size_t kHeadSize = 12;
+  const auto &shape = input.meta.shape;
+  auto type_size = dali_type_size(input.meta.type);
+  size_t buffer_idx = 0, buffer_offset = 0;
+  for (int sample_idx = 0; sample_idx < shape.num_samples(); ++sample_idx) {
+    size_t sample_size = volume(shape.tensor_shape_span(sample_idx)) * type_size;
+    ENFORCE(sample_size > 0,
+            make_string("Sample ", sample_idx, " of input ", input.meta.name, " is empty."));
+    // Gather the head of the sample, it might span several buffers
+    uint8_t head[kHeadSize];
+    size_t head_size = 0;
+    bool on_host = true;
+    size_t remaining = sample_size;
+    while (remaining > 0 && buffer_idx < input.buffers.size()) {
+      auto &buffer = input.buffers[buffer_idx];
+      size_t n = std::min(remaining, buffer.size - buffer_offset);
+      on_host = on_host && buffer.device == device_type_t::CPU;
+      if (on_host && head_size < kHeadSize) {
+        size_t head_n = std::min(n, kHeadSize - head_size);
+        std::memcpy(head + head_size, static_cast<const uint8_t *>(buffer.data) + buffer_offset,
+                    head_n);
+        head_size += head_n;
+      }
+      remaining -= n;
+      buffer_offset += n;
+      if (buffer_offset == buffer.size) {
+        buffer_idx++;
+        buffer_offset = 0;
+      }
+    }
+    ENFORCE(remaining == 0,
+            make_string("Input ", input.meta.name, " has less data than its shape declares."));
+    ENFORCE(!on_host || HasImageSignature(head, head_size),
+            make_string("Sample ", sample_idx, " of input ", input.meta.name,
+                        " is not an encoded image."));
+  }
+}
+
 }}}  // namespace triton::backend::dali
@@ -23,7 +23,11 @@
 #ifndef TRITONDALIBACKEND_IO_BUFFER_H
 #define TRITONDALIBACKEND_IO_BUFFER_H
 
+#include <memory>
+#include <utility>
+
 #include "src/dali_executor/io_descriptor.h"
+#include "src/dali_executor/memory_pool.h"
 #include "src/dali_executor/utils/dali.h"
 
 namespace triton { namespace backend { namespace dali {
@@ -32,6 +36,35 @@ namespace triton { namespace backend { namespace dali {
 void MemCopy(device_type_t dst_dev, void *dst, device_type_t src_dev, const void *src, size_t size,
              cudaStream_t stream = 0);
 
+/**
+ * @brief Unpack host buffers holding length-prefixed elements (Triton's BYTES serialization).
+ *
+ * Each element is a 4-byte little-endian length followed by the payload and becomes
+ * a separate, one-dimensional sample. The data is not copied.
+ * @param buffers Consecutive chunks of the serialized data. Elements cannot span chunks.
+ * @param num_samples Number of elements in the buffers.
+ * @param[out] samples Descriptors of the payloads are appended here.
+ * @return Shape of the unpacked samples.
+ */
+TensorListShape<> UnpackBytes(const std::vector<IBufferDescr> &buffers, int num_samples,
+                              std::vector<IBufferDescr> &samples);
+
+/**
+ * @brief Check if the data starts with the signature of an image format decoded by DALI
+ *        (JPEG, PNG, BMP, TIFF, JPEG 2000, WebP or PNM).
+ * @param head First bytes of the data, 12 are enough for every format.
+ */
+bool HasImageSignature(const uint8_t *head, size_t size);
+
+/**
+ * @brief Verify that each sample of an input is an encoded image, judging by its first bytes.
+ *
+ * It's a cheap check, so that a request with garbage in place of an image can be rejected
+ * before it's batched with others. Samples that are not in the host memory are not checked.
+ * @throws DaliBackendException naming the first sample that is not an image.
+ */
+void CheckEncodedImages(const IDescr &input);
+
 class IOBufferI {
  public:
   /**
@@ -108,6 +141,57 @@ class IOBuffer : public IOBufferI {
   int device_id_ = 0;
 };
 
+/**
+ * @brief Buffer allocated from a MemoryPool.
+ *
+ * The memory is returned to the pool, when the buffer is destroyed.
+ * Unlike IOBuffer, the contents are not preserved when the buffer grows.
+ */
+class PooledIOBuffer : public IOBufferI {
+ public:
+  explicit PooledIOBuffer(std::shared_ptr<MemoryPool> pool, size_t size = 0) :
+      pool_(std::move(pool)) {
+    resize(size);
+  }
+
+  void resize(size_t size) override {
+    if (size > capacity_) {
+      block_.reset();
+      block_ = pool_->Allocate(size);
+      capacity_ = block_.get_deleter().size_class();
+    }
+    size_ = size;
+  }
+
+  device_type_t device_type() const override {
+    return pool_->Kind() == MemoryKind::Device ? device_type_t::GPU : device_type_t::CPU;
+  }
+
+  IBufferDescr get_descr() const override {
+    IBufferDescr descr;
+    descr.data = block_.get();
+    descr.size = size_;
+    descr.device = device_type();
+    descr.device_id = pool_->DeviceId();
+    return descr;
+  }
+
+  OBufferDescr get_descr() override {
+    OBufferDescr descr;
+    descr.data = block_.get();
+    descr.size = size_;
+    descr.device = device_type();
+    descr.device_id = pool_->DeviceId();
+    return descr;
+  }
+
+ private:
+  std::shared_ptr<MemoryPool> pool_;
+  MemoryPool::Block block_{};
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+};
+
 }}}  // namespace triton::backend::dali
 
 #endif  // TRITONDALIBACKEND_IO_BUFFER_H
@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <catch2/catch.hpp>
 
 #include "src/dali_executor/io_buffer.h"
@@ -27,8 +28,9 @@
 
 namespace triton { namespace backend { namespace dali { namespace test {
 
-template<device_type_t Dev>
-void test_buffer(IOBuffer<Dev> &buffer) {
+template<typename Buffer>
+void test_buffer(Buffer &buffer) {
+  const auto Dev = buffer.device_type();
   const uint8_t N = 10;
   const size_t size = N * (N + 1) / 2;
   buffer.resize(size);
@@ -68,6 +70,122 @@ TEST_CASE("IOBuffer<GPU> extend & copy") {
     test_buffer(buffer);
   }
 }
+TEST_CASE("PooledIOBuffer extend & copy") {
+  auto pool = MemoryPool::Create(MemoryKind::Pinned);
+  PooledIOBuffer buffer(pool);
 
+  SECTION("Copy") {
+    test_buffer(buffer);
+  }
+
+  SECTION("Reuse pooled memory") {
+    buffer.resize(5000);
+    auto data = buffer.get_descr().data;
+    buffer.resize(8000);
+    REQUIRE(buffer.get_descr().data == data);  // both sizes fall into the same size class
+    buffer.resize(10000);                       // the previous block goes back to the pool
+    PooledIOBuffer reusing(pool, 6000);
+    REQUIRE(reusing.get_descr().data == data);
+  }
+}
+
+TEST_CASE("PooledIOBuffer<GPU> extend & copy") {
+  PooledIOBuffer buffer(MemoryPool::Create(MemoryKind::Device, 0));
+
+  SECTION("Copy") {
+    test_buffer(buffer);
+  }
+}
+
+TEST_CASE("Unpack BYTES input") {
+  const std::vector<std::string> elements = {"abc", "", "defgh", "i"};
+  std::vector<uint8_t> serialized;
+  for (auto &elem : elements) {
+    uint32_t len = elem.size();
+    for (int i = 0; i < 4; ++i) {
+      serialized.push_back((len >> (8 * i)) & 0xFF);
+    }
+    serialized.insert(serialized.end(), elem.begin(), elem.end());
+  }
+  IBufferDescr buffer;
+  buffer.device = device_type_t::CPU;
+  buffer.data = serialized.data();
+  buffer.size = serialized.size();
+
+  SECTION("Unpack") {
+    std::vector<IBufferDescr> samples;
+    auto shape = UnpackBytes({buffer}, elements.size(), samples);
+    REQUIRE(shape.num_samples() == 4);
+    REQUIRE(shape.sample_dim() == 1);
+    std::string unpacked;
+    for (auto &sample : samples) {
+      unpacked.append(reinterpret_cast<const char *>(sample.data), sample.size);
+    }
+    REQUIRE(unpacked == "abcdefghi");
+    for (size_t i = 0; i < elements.size(); ++i) {
+      REQUIRE(shape[i][0] == static_cast<int64_t>(elements[i].size()));
+    }
+  }
+
+  SECTION("Wrong number of elements") {
+    std::vector<IBufferDescr> samples;
+    REQUIRE_THROWS(UnpackBytes({buffer}, 3, samples));
+    REQUIRE_THROWS(UnpackBytes({buffer}, 5, samples));
+  }
+
+  SECTION("Truncated element") {
+    std::vector<IBufferDescr> samples;
+    buffer.size -= 1;
+    REQUIRE_THROWS(UnpackBytes({buffer}, elements.size(), samples));
+  }
+}
+
+TEST_CASE("Check encoded images") {
+  const std::vector<uint8_t> jpeg = {0xFF, 0xD8, 0xFF, 0xE0, 0, 0x10};
+  const std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n', 0, 0};
+  const std::vector<uint8_t> garbage = {'n', 'o', 't', ' ', 'a', 'n', ' ', 'i', 'm', 'g'};
+  REQUIRE(HasImageSignature(jpeg.data(), jpeg.size()));
+  REQUIRE(HasImageSignature(png.data(), png.size()));
+  REQUIRE(!HasImageSignature(garbage.data(), garbage.size()));
+  REQUIRE(!HasImageSignature(png.data(), 4));
+
+  std::vector<uint8_t> data;
+  auto make_input = [&](const std::vector<std::vector<uint8_t>> &samples, size_t chunk) {
+    data.clear();
+    IDescr input;
+    input.meta.name = "images";
+    input.meta.type = DALI_UINT8;
+    input.meta.shape.resize(samples.size(), 1);
+    for (size_t i = 0; i < samples.size(); ++i) {
+      data.insert(data.end(), samples[i].begin(), samples[i].end());
+      input.meta.shape.set_tensor_shape(i, TensorShape<1>(samples[i].size()));
+    }
+    for (size_t offset = 0; offset < data.size(); offset += chunk) {
+      IBufferDescr buffer;
+      buffer.device = device_type_t::CPU;
+      buffer.data = data.data() + offset;
+      buffer.size = std::min(chunk, data.size() - offset);
+      input.buffers.push_back(buffer);
+    }
+    return input;
+  };
+
+  SECTION("Images") {
+    REQUIRE_NOTHROW(CheckEncodedImages(make_input({jpeg, png, jpeg}, 1024)));
+  }
+
+  SECTION("Images spanning buffers") {
+    REQUIRE_NOTHROW(CheckEncodedImages(make_input({jpeg, png, jpeg}, 3)));
+  }
+
+  SECTION("Garbage") {
+    REQUIRE_THROWS(CheckEncodedImages(make_input({jpeg, garbage, png}, 1024)));
+    REQUIRE_THROWS(CheckEncodedImages(make_input({jpeg, garbage, png}, 3)));
+  }
+
+  SECTION("Empty sample") {
+    REQUIRE_THROWS(CheckEncodedImages(make_input({jpeg, {}, png}, 1024)));
+  }
+}
 
 }}}}  // namespace triton::backend::dali::test
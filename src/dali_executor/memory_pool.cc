@@ -0,0 +1,212 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "src/dali_executor/memory_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+namespace triton { namespace backend { namespace dali {
+
+constexpr size_t MemoryPool::kMinSizeClass;
+constexpr size_t MemoryPool::kMaxOversize;
+
+namespace {
+
+std::mutex registry_mutex;
+size_t default_max_cached_bytes = static_cast<size_t>(-1);
+
+}  // namespace
+
+void MemoryPool::SetDefaultMaxCachedBytes(size_t max_cached_bytes) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  default_max_cached_bytes = max_cached_bytes;
+}
+
+std::shared_ptr<MemoryPool> MemoryPool::Get(MemoryKind kind, int device_id) {
+  static std::map<std::tuple<MemoryKind, int>, std::weak_ptr<MemoryPool>> registry;
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto &entry = registry[std::make_tuple(kind, device_id)];
+  auto pool = entry.lock();
+  if (!pool) {
+    pool = Create(kind, device_id);
+    std::lock_guard<std::mutex> pool_lock(pool->mutex_);
+    pool->default_max_cached_bytes_ = default_max_cached_bytes;
+    pool->UpdateMaxCachedBytes();
+    entry = pool;
+  }
+  return pool;
+}
+
+size_t MemoryPool::SizeClass(size_t size) {
+  size_t size_class = kMinSizeClass;
+  while (size_class < size) {
+    size_class <<= 1;
+  }
+  return size_class;
+}
+
+MemoryPool::Block MemoryPool::Allocate(size_t size) {
+  auto size_class = SizeClass(size);
+  uint8_t *ptr = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = free_blocks_.lower_bound(size_class);
+         it != free_blocks_.end() && it->first <= size_class * kMaxOversize; ++it) {
+      if (!it->second.empty()) {
+        size_class = it->first;
+        ptr = it->second.back();
+        it->second.pop_back();
+        stats_.cached_bytes -= size_class;
+        break;
+      }
+    }
+  }
+  if (!ptr) {
+    try {
+      ptr = AllocateBlock(size_class);
+    } catch (const DaliBackendException &) {
+      // Out of memory is likely, give back the cached blocks and retry once
+      Trim();
+      ptr = AllocateBlock(size_class);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.used_bytes += size_class;
+    stats_.peak_bytes = std::max(stats_.peak_bytes, stats_.used_bytes + stats_.cached_bytes);
+  }
+  return Block(ptr, BlockDeleter(shared_from_this(), size_class));
+}
+
+bool MemoryPool::Reserve(size_t size, int count) {
+  {
+    std::vector<Block> blocks;
+    for (int i = 0; i < count; ++i) {
+      blocks.push_back(Allocate(size));
+    }
+  }  // the blocks are released to the cache here
+  std::lock_guard<std::mutex> lock(mutex_);
+  return SizeClass(size) * count <= max_cached_bytes_;
+}
+
+void MemoryPool::Release(uint8_t *ptr, size_t size_class) {
+  if (!ptr)
+    return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.used_bytes -= size_class;
+  if (size_class > max_cached_bytes_) {
+    FreeBlock(ptr);
+    return;
+  }
+  free_blocks_[size_class].push_back(ptr);
+  stats_.cached_bytes += size_class;
+  TrimTo(max_cached_bytes_);
+}
+
+MemoryPool::CacheLimit MemoryPool::LimitCachedBytes(size_t max_cached_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto limit = limits_.insert(max_cached_bytes);
+  UpdateMaxCachedBytes();
+  TrimTo(max_cached_bytes_);
+  auto pool = shared_from_this();
+  return CacheLimit(nullptr, [pool, limit](void *) {
+    std::lock_guard<std::mutex> lock(pool->mutex_);
+    pool->limits_.erase(limit);
+    pool->UpdateMaxCachedBytes();
+  });
+}
+
+void MemoryPool::UpdateMaxCachedBytes() {
+  max_cached_bytes_ = default_max_cached_bytes_;
+  if (!limits_.empty())
+    max_cached_bytes_ = std::min(max_cached_bytes_, *limits_.begin());
+}
+
+void MemoryPool::Trim() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TrimTo(0);
+}
+
+MemoryPool::Stats MemoryPool::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void MemoryPool::TrimTo(size_t max_cached_bytes) {
+  for (auto it = free_blocks_.rbegin();
+       it != free_blocks_.rend() && stats_.cached_bytes > max_cached_bytes; ++it) {
+    auto &blocks = it->second;
+    while (!blocks.empty() && stats_.cached_bytes > max_cached_bytes) {
+      FreeBlock(blocks.back());
+      blocks.pop_back();
+      stats_.cached_bytes -= it->first;
+    }
+  }
+}
+
+uint8_t *MemoryPool::AllocateBlock(size_t size) {
+  void *mem = nullptr;
+  switch (kind_) {
+    case MemoryKind::Host:
+      mem = std::malloc(size);
+      ENFORCE(mem, make_string("Failed to allocate ", size, " bytes of host memory."));
+      break;
+    case MemoryKind::Pinned:
+      CUDA_CALL_GUARD(cudaMallocHost(&mem, size));
+      break;
+    case MemoryKind::Device: {
+      DeviceGuard dg(device_id_);
+      CUDA_CALL_GUARD(cudaMalloc(&mem, size));
+      break;
+    }
+  }
+  return reinterpret_cast<uint8_t *>(mem);
+}
+
+void MemoryPool::FreeBlock(uint8_t *ptr) {
+  switch (kind_) {
+    case MemoryKind::Host:
+      std::free(ptr);
+      break;
+    case MemoryKind::Pinned:
+      cudaFreeHost(ptr);
+      break;
+    case MemoryKind::Device: {
+      DeviceGuard dg(device_id_);
+      cudaFree(ptr);
+      break;
+    }
+  }
+}
+
+MemoryPool::~MemoryPool() {
+  for (auto &blocks : free_blocks_) {
+    for (auto *ptr : blocks.second) {
+      FreeBlock(ptr);
+    }
+  }
+}
+
+}}}  // namespace triton::backend::dali
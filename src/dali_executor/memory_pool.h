@@ -0,0 +1,196 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TRITONDALIBACKEND_MEMORY_POOL_H
+#define TRITONDALIBACKEND_MEMORY_POOL_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "src/dali_executor/utils/dali.h"
+#include "src/error_handling.h"
+
+namespace triton { namespace backend { namespace dali {
+
+enum class MemoryKind {
+  Host,    // pageable host memory
+  Pinned,  // page-locked host memory
+  Device,  // device memory
+};
+
+/**
+ * @brief Pool of memory blocks grouped in size classes.
+ *
+ * The allocations are rounded up to a power of 2 (size class). Released blocks are cached
+ * in the pool and reused by the subsequent allocations of the same size class.
+ * The amount of cached memory is bounded by a high-water mark; the blocks above it are
+ * freed, the largest ones first.
+ */
+class MemoryPool : public std::enable_shared_from_this<MemoryPool> {
+ public:
+  class BlockDeleter {
+   public:
+    BlockDeleter() = default;
+
+    BlockDeleter(std::shared_ptr<MemoryPool> pool, size_t size_class) :
+        pool_(std::move(pool)), size_class_(size_class) {}
+
+    void operator()(uint8_t *ptr) const {
+      pool_->Release(ptr, size_class_);
+    }
+
+    size_t size_class() const {
+      return size_class_;
+    }
+
+   private:
+    std::shared_ptr<MemoryPool> pool_{};
+    size_t size_class_ = 0;
+  };
+
+  using Block = std::unique_ptr<uint8_t, BlockDeleter>;
+
+  struct Stats {
+    size_t used_bytes = 0;    // held by the users of the pool
+    size_t cached_bytes = 0;  // released, kept for reuse
+    size_t peak_bytes = 0;    // maximum of used + cached
+  };
+
+  /**
+   * @brief Create a pool of a given kind.
+   * @param device_id Device of the memory. Allocations are made on it only by
+   *                  the MemoryKind::Device pools.
+   */
+  static std::shared_ptr<MemoryPool> Create(MemoryKind kind, int device_id = 0) {
+    return std::shared_ptr<MemoryPool>(new MemoryPool(kind, device_id));
+  }
+
+  /**
+   * @brief Get a pool shared by all the users of a given memory kind and device.
+   *
+   * Host memory pools are kept per device as well, so that the memory is reused by
+   * the threads working for the same device, and stays local to its NUMA node.
+   * The pool lives as long as anybody uses it.
+   */
+  static std::shared_ptr<MemoryPool> Get(MemoryKind kind, int device_id = 0);
+
+  /**
+   * @brief Set the limit of the cached memory for the pools created by Get() from now on.
+   */
+  static void SetDefaultMaxCachedBytes(size_t max_cached_bytes);
+
+  /**
+   * @brief Get a block of at least \p size bytes.
+   *
+   * If there's no cached block of the size class, a cached block up to kMaxOversize
+   * times larger is used, before a new one is allocated.
+   * The block is returned to the pool, when it's destroyed.
+   */
+  Block Allocate(size_t size);
+
+  /**
+   * @brief Make sure that at least \p count blocks serving allocations of \p size bytes
+   *        are cached, so that the first allocations of that size don't wait for the memory.
+   *
+   * The blocks are subject to the limit of the cached memory. The pool is shared, so the blocks
+   * reserved by one user serve the reservations of the others too.
+   * @return False, if the blocks don't fit in the limit of the cached memory,
+   *         so some of them are freed right away.
+   */
+  bool Reserve(size_t size, int count = 1);
+
+  /**
+   * @brief Handle of a limit of the cached memory. The limit is lifted when it's destroyed.
+   */
+  using CacheLimit = std::shared_ptr<void>;
+
+  /**
+   * @brief Limit the amount of the cached memory while the returned handle is held.
+   *        The pool is trimmed immediately.
+   *
+   * The pool can be shared by many users, so the smallest of the limits held applies.
+   * When a user releases its limit, the smallest of the remaining ones applies from then on.
+   */
+  CacheLimit LimitCachedBytes(size_t max_cached_bytes);
+
+  /**
+   * @brief Free all the cached blocks.
+   */
+  void Trim();
+
+  Stats GetStats() const;
+
+  MemoryKind Kind() const {
+    return kind_;
+  }
+
+  int DeviceId() const {
+    return device_id_;
+  }
+
+  /**
+   * @brief Return the size of the memory block, that serves allocations of \p size bytes.
+   */
+  static size_t SizeClass(size_t size);
+
+  ~MemoryPool();
+
+ private:
+  MemoryPool(MemoryKind kind, int device_id) : kind_(kind), device_id_(device_id) {}
+
+  void Release(uint8_t *ptr, size_t size_class);
+
+  /**
+   * @brief Update max_cached_bytes_ to the smallest of the limits.
+   *        Must be called with the mutex_ locked.
+   */
+  void UpdateMaxCachedBytes();
+
+  /**
+   * @brief Free cached blocks until at most \p max_cached_bytes are left.
+   *        Must be called with the mutex_ locked.
+   */
+  void TrimTo(size_t max_cached_bytes);
+
+  uint8_t *AllocateBlock(size_t size);
+
+  void FreeBlock(uint8_t *ptr);
+
+  static constexpr size_t kMinSizeClass = 4096;
+  static constexpr size_t kMaxOversize = 4;
+
+  const MemoryKind kind_;
+  const int device_id_;
+  mutable std::mutex mutex_;
+  std::map<size_t, std::vector<uint8_t *>> free_blocks_;
+  size_t default_max_cached_bytes_ = static_cast<size_t>(-1);  // of the backend
+  std::multiset<size_t> limits_;                                // held by the users
+  size_t max_cached_bytes_ = static_cast<size_t>(-1);          // the smallest of them all
+  Stats stats_{};
+};
+
+}}}  // namespace triton::backend::dali
+
+#endif  // TRITONDALIBACKEND_MEMORY_POOL_H
@@ -0,0 +1,112 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <catch2/catch.hpp>
+
+#include "src/dali_executor/memory_pool.h"
+
+namespace triton { namespace backend { namespace dali { namespace test {
+
+TEST_CASE("MemoryPool size classes") {
+  REQUIRE(MemoryPool::SizeClass(1) == 4096u);
+  REQUIRE(MemoryPool::SizeClass(4096) == 4096u);
+  REQUIRE(MemoryPool::SizeClass(4097) == 8192u);
+  REQUIRE(MemoryPool::SizeClass(1000000) == (1u << 20));
+}
+
+TEST_CASE("MemoryPool statistics & limits") {
+  auto pool = MemoryPool::Create(MemoryKind::Host);
+
+  SECTION("Usage") {
+    auto block = pool->Allocate(5000);
+    REQUIRE(pool->GetStats().used_bytes == 8192u);
+    REQUIRE(pool->GetStats().cached_bytes == 0u);
+    block.reset();
+    REQUIRE(pool->GetStats().used_bytes == 0u);
+    REQUIRE(pool->GetStats().cached_bytes == 8192u);
+    REQUIRE(pool->GetStats().peak_bytes == 8192u);
+    pool->Trim();
+    REQUIRE(pool->GetStats().cached_bytes == 0u);
+  }
+
+  SECTION("High-water mark") {
+    auto small = pool->Allocate(4096);
+    auto large = pool->Allocate(16384);
+    auto limit = pool->LimitCachedBytes(10000);
+    large.reset();  // exceeds the limit, freed right away
+    REQUIRE(pool->GetStats().cached_bytes == 0u);
+    small.reset();
+    REQUIRE(pool->GetStats().cached_bytes == 4096u);
+    auto larger_limit = pool->LimitCachedBytes(20000);  // the smaller limit stays
+    auto again = pool->Allocate(16384);
+    again.reset();
+    REQUIRE(pool->GetStats().cached_bytes == 4096u);
+    auto medium = pool->Allocate(8192);
+    medium.reset();
+    REQUIRE(pool->GetStats().cached_bytes == 4096u);
+    limit.reset();  // the larger limit applies now
+    medium = pool->Allocate(8192);
+    medium.reset();
+    REQUIRE(pool->GetStats().cached_bytes == 4096u + 8192u);
+    larger_limit.reset();  // no limit
+    again = pool->Allocate(16384);
+    again.reset();
+    REQUIRE(pool->GetStats().cached_bytes == 4096u + 8192u + 16384u);
+  }
+
+  SECTION("Reserve") {
+    REQUIRE(pool->Reserve(100000, 2));
+    REQUIRE(pool->GetStats().cached_bytes == 2 * 131072u);
+    auto block = pool->Allocate(100000);
+    REQUIRE(pool->GetStats().cached_bytes == 131072u);
+    REQUIRE(pool->Reserve(100000, 2));  // one is still cached
+    REQUIRE(pool->GetStats().cached_bytes == 2 * 131072u);
+  }
+
+  SECTION("Reserve over the limit") {
+    auto limit = pool->LimitCachedBytes(200000);
+    REQUIRE(!pool->Reserve(100000, 2));
+    REQUIRE(pool->GetStats().cached_bytes == 131072u);
+    REQUIRE(!pool->Reserve(300000));
+    REQUIRE(pool->GetStats().cached_bytes == 131072u);
+  }
+
+  SECTION("Oversized blocks") {
+    pool->Reserve(65536);
+    auto smaller = pool->Allocate(20000);  // 32768 class, served by the cached block
+    REQUIRE(pool->GetStats().cached_bytes == 0u);
+    REQUIRE(pool->GetStats().used_bytes == 65536u);
+    smaller.reset();
+    auto much_smaller = pool->Allocate(4096);  // 16x smaller, gets its own block
+    REQUIRE(pool->GetStats().cached_bytes == 65536u);
+    REQUIRE(pool->GetStats().used_bytes == 4096u);
+  }
+
+  SECTION("Shared pools") {
+    auto shared = MemoryPool::Get(MemoryKind::Host);
+    REQUIRE(shared == MemoryPool::Get(MemoryKind::Host));
+    REQUIRE(shared != MemoryPool::Get(MemoryKind::Pinned));
+    REQUIRE(shared != pool);
+  }
+}
+
+}}}}  // namespace triton::backend::dali::test
@@ -0,0 +1,184 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "src/dali_executor/output_cache.h"
+
+#include <cstring>
+#include <iterator>
+
+namespace triton { namespace backend { namespace dali {
+
+namespace {
+
+constexpr uint64_t kHashSeed = 0xcbf29ce484222325ull;
+constexpr uint64_t kHashPrime = 0x100000001b3ull;
+
+inline uint64_t HashWord(uint64_t hash, uint64_t word) {
+  hash = (hash ^ word) * kHashPrime;
+  return hash ^ (hash >> 32);
+}
+
+/**
+ * @brief FNV-1a variant consuming 8 bytes at a time.
+ */
+uint64_t HashBytes(uint64_t hash, const void *data, size_t size) {
+  if (size == 0)
+    return HashWord(hash, 0);
+  auto bytes = reinterpret_cast<const char *>(data);
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = HashWord(hash, word);
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, bytes + i, size - i);
+  return HashWord(hash, tail ^ (static_cast<uint64_t>(size) << 56));
+}
+
+}  // namespace
+
+uint64_t HashInputs(const std::vector<IDescr> &inputs) {
+  uint64_t hash = kHashSeed;
+  for (auto &input : inputs) {
+    hash = HashBytes(hash, input.meta.name.data(), input.meta.name.size());
+    hash = HashWord(hash, static_cast<uint64_t>(input.meta.type));
+    const auto &shape = input.meta.shape;
+    hash = HashWord(hash, shape.num_samples());
+    hash = HashWord(hash, shape.sample_dim());
+    hash = HashBytes(hash, shape.shapes.data(), shape.shapes.size() * sizeof(int64_t));
+    for (auto &buffer : input.buffers) {
+      if (buffer.device != device_type_t::CPU)
+        return 0;
+      hash = HashBytes(hash, buffer.data, buffer.size);
+    }
+  }
+  return hash == 0 ? 1 : hash;
+}
+
+uint64_t HashData(const void *data, size_t size) {
+  return HashBytes(kHashSeed, data, size);
+}
+
+bool OutputCache::Key::Matches(const std::vector<IDescr> &other) const {
+  if (other.size() != inputs.size())
+    return false;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const auto &stored = inputs[i];
+    const auto &input = other[i];
+    if (input.meta.name != stored.name || input.meta.type != stored.type ||
+        input.meta.shape != stored.shape)
+      return false;
+    size_t offset = 0;
+    for (auto &buffer : input.buffers) {
+      if (buffer.device != device_type_t::CPU || offset + buffer.size > stored.data.size())
+        return false;
+      if (buffer.size > 0 && std::memcmp(stored.data.data() + offset, buffer.data, buffer.size))
+        return false;
+      offset += buffer.size;
+    }
+    if (offset != stored.data.size())
+      return false;
+  }
+  return true;
+}
+
+std::shared_ptr<const OutputCache::Entry> OutputCache::Find(uint64_t hash,
+                                                            const std::vector<IDescr> &inputs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(hash);
+  if (it == index_.end() || !it->second->key->Matches(inputs)) {
+    stats_.misses++;
+    return nullptr;
+  }
+  stats_.hits++;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->entry;
+}
+
+std::shared_ptr<const OutputCache::Key> OutputCache::MakeKey(uint64_t hash,
+                                                             const std::vector<IDescr> &inputs) {
+  auto key = std::make_shared<Key>();
+  key->hash = hash;
+  key->inputs.resize(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    auto &stored = key->inputs[i];
+    stored.name = inputs[i].meta.name;
+    stored.type = inputs[i].meta.type;
+    stored.shape = inputs[i].meta.shape;
+    for (auto &buffer : inputs[i].buffers) {
+      ENFORCE(buffer.device == device_type_t::CPU, "Only host inputs can be cached.");
+      auto data = reinterpret_cast<const char *>(buffer.data);
+      stored.data.insert(stored.data.end(), data, data + buffer.size);
+    }
+  }
+  return key;
+}
+
+void OutputCache::Insert(std::shared_ptr<const Key> key, Entry entry) {
+  auto size = EntrySize(entry) + KeySize(*key);
+  if (size > max_bytes_)
+    return;
+  auto shared_entry = std::make_shared<const Entry>(std::move(entry));
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key->hash);
+  if (it != index_.end())
+    Erase(it->second);
+  while (stats_.bytes + size > max_bytes_) {
+    Erase(std::prev(lru_.end()));
+  }
+  auto hash = key->hash;
+  lru_.push_front({std::move(key), std::move(shared_entry), size});
+  index_[hash] = lru_.begin();
+  stats_.bytes += size;
+  stats_.entries++;
+}
+
+OutputCache::Stats OutputCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+size_t OutputCache::EntrySize(const Entry &entry) {
+  size_t size = 0;
+  for (auto &output : entry) {
+    size += output.data.size();
+  }
+  return size;
+}
+
+size_t OutputCache::KeySize(const Key &key) {
+  size_t size = 0;
+  for (auto &input : key.inputs) {
+    size += input.data.size();
+  }
+  return size;
+}
+
+void OutputCache::Erase(LruList::iterator it) {
+  stats_.bytes -= it->size;
+  stats_.entries--;
+  index_.erase(it->key->hash);
+  lru_.erase(it);
+}
+
+}}}  // namespace triton::backend::dali
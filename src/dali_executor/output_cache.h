@@ -0,0 +1,151 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TRITONDALIBACKEND_OUTPUT_CACHE_H
+#define TRITONDALIBACKEND_OUTPUT_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "src/dali_executor/io_descriptor.h"
+#include "src/dali_executor/utils/dali.h"
+
+namespace triton { namespace backend { namespace dali {
+
+/**
+ * @brief Hash the names, types, shapes and data of the \p inputs of a request.
+ * @return 0, if any of the inputs is not in the host memory and cannot be hashed.
+ */
+uint64_t HashInputs(const std::vector<IDescr> &inputs);
+
+/**
+ * @brief Hash \p size bytes of host memory, e.g. of a serialized pipeline.
+ */
+uint64_t HashData(const void *data, size_t size);
+
+/**
+ * @brief Size-bounded LRU cache of the outputs produced for the requests.
+ *
+ * The entries are found by HashInputs of the request, and served only if the inputs of the
+ * request are the same as the ones stored with the entry. Thread-safe.
+ */
+class OutputCache {
+ public:
+  struct Output {
+    TensorListShape<> shape;
+    dali_data_type_t type;
+    std::vector<char> data;  // host copy of the samples
+  };
+
+  using Entry = std::vector<Output>;  // indexed by the pipeline output
+
+  struct Input {
+    std::string name;
+    TensorListShape<> shape;
+    dali_data_type_t type;
+    std::vector<char> data;  // host copy of the samples
+  };
+
+  /**
+   * @brief Inputs of a request, for which the outputs are stored, with their hash.
+   */
+  struct Key {
+    uint64_t hash = 0;
+    std::vector<Input> inputs;
+
+    /**
+     * @brief Check if the \p inputs are the same as the stored ones.
+     */
+    bool Matches(const std::vector<IDescr> &inputs) const;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t bytes = 0;
+    size_t entries = 0;
+
+    double HitRate() const {
+      auto lookups = hits + misses;
+      return lookups == 0 ? 0. : static_cast<double>(hits) / lookups;
+    }
+  };
+
+  /**
+   * @param max_bytes Upper bound for the size of the data of all the entries.
+   */
+  explicit OutputCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+  /**
+   * @brief Find the entry stored for the \p inputs with a given \p hash
+   *        and mark it as the most recently used.
+   *
+   * An entry with the same hash, but stored for other inputs, counts as a miss.
+   * @return nullptr, if there's no such entry.
+   */
+  std::shared_ptr<const Entry> Find(uint64_t hash, const std::vector<IDescr> &inputs);
+
+  /**
+   * @brief Make a key for the \p inputs (in the host memory) with a given \p hash.
+   */
+  static std::shared_ptr<const Key> MakeKey(uint64_t hash, const std::vector<IDescr> &inputs);
+
+  /**
+   * @brief Store the \p entry under a given \p key, evicting the least recently used entries.
+   *
+   * Entries larger than the cache capacity (with the inputs in the key) are not stored.
+   */
+  void Insert(std::shared_ptr<const Key> key, Entry entry);
+
+  Stats GetStats() const;
+
+  static size_t EntrySize(const Entry &entry);
+
+  static size_t KeySize(const Key &key);
+
+ private:
+  struct Stored {
+    std::shared_ptr<const Key> key;
+    std::shared_ptr<const Entry> entry;
+    size_t size;
+  };
+
+  using LruList = std::list<Stored>;
+
+  void Erase(LruList::iterator it);
+
+  size_t max_bytes_;
+  Stats stats_{};
+  LruList lru_{};  // the most recently used first
+  std::unordered_map<uint64_t, LruList::iterator> index_{};
+  mutable std::mutex mutex_;
+};
+
+}}}  // namespace triton::backend::dali
+
+#endif  // TRITONDALIBACKEND_OUTPUT_CACHE_H
@@ -0,0 +1,178 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include "src/dali_executor/output_cache.h"
+
+namespace triton { namespace backend { namespace dali { namespace test {
+
+namespace {
+
+OutputCache::Entry MakeEntry(size_t size, char value) {
+  OutputCache::Output output{};
+  output.shape = TensorListShape<>::make_uniform(1, TensorShape<>(static_cast<int64_t>(size)));
+  output.type = dali_data_type_t::DALI_UINT8;
+  output.data.assign(size, value);
+  return {output};
+}
+
+IDescr MakeInput(const std::string &name, std::vector<uint8_t> &data,
+                 device_type_t device = device_type_t::CPU) {
+  IDescr input{};
+  input.meta.name = name;
+  input.meta.type = dali_data_type_t::DALI_UINT8;
+  auto size = static_cast<int64_t>(data.size());
+  input.meta.shape = TensorListShape<>::make_uniform(1, TensorShape<>(size));
+  IBufferDescr buffer{};
+  buffer.device = device;
+  buffer.data = data.data();
+  buffer.size = data.size();
+  input.buffers = {buffer};
+  return input;
+}
+
+/**
+ * Inputs without any data, so that they don't count towards the size of the entry.
+ */
+std::vector<IDescr> KeyInputs(uint64_t n) {
+  IDescr input{};
+  input.meta.name = "INPUT" + std::to_string(n);
+  input.meta.type = dali_data_type_t::DALI_UINT8;
+  return {input};
+}
+
+std::shared_ptr<const OutputCache::Key> MakeKey(uint64_t n) {
+  return OutputCache::MakeKey(n, KeyInputs(n));
+}
+
+std::shared_ptr<const OutputCache::Entry> Find(OutputCache &cache, uint64_t n) {
+  return cache.Find(n, KeyInputs(n));
+}
+
+}  // namespace
+
+TEST_CASE("OutputCache LRU eviction") {
+  OutputCache cache(300);
+  cache.Insert(MakeKey(1), MakeEntry(100, 'a'));
+  cache.Insert(MakeKey(2), MakeEntry(100, 'b'));
+  cache.Insert(MakeKey(3), MakeEntry(100, 'c'));
+  REQUIRE(cache.GetStats().bytes == 300u);
+  REQUIRE(Find(cache, 1));  // 2 becomes the least recently used
+  cache.Insert(MakeKey(4), MakeEntry(100, 'd'));
+  REQUIRE(Find(cache, 2) == nullptr);
+  auto entry = Find(cache, 1);
+  REQUIRE(entry);
+  REQUIRE((*entry)[0].data[0] == 'a');
+  REQUIRE(cache.GetStats().entries == 3u);
+
+  SECTION("Too large entries are not stored") {
+    cache.Insert(MakeKey(5), MakeEntry(301, 'e'));
+    REQUIRE(Find(cache, 5) == nullptr);
+    REQUIRE(cache.GetStats().entries == 3u);
+  }
+
+  SECTION("Replacing an entry") {
+    cache.Insert(MakeKey(1), MakeEntry(50, 'f'));
+    REQUIRE((*Find(cache, 1))[0].data.size() == 50u);
+    REQUIRE(cache.GetStats().bytes == 250u);
+  }
+}
+
+TEST_CASE("OutputCache hit rate") {
+  OutputCache cache(1000);
+  cache.Insert(MakeKey(1), MakeEntry(10, 'a'));
+  Find(cache, 1);
+  Find(cache, 1);
+  Find(cache, 1);
+  Find(cache, 2);
+  auto stats = cache.GetStats();
+  REQUIRE(stats.hits == 3u);
+  REQUIRE(stats.misses == 1u);
+  REQUIRE(stats.HitRate() == Approx(0.75));
+}
+
+TEST_CASE("OutputCache hash collisions") {
+  OutputCache cache(1000);
+  std::vector<uint8_t> data1 = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  std::vector<uint8_t> data2 = data1;
+  data2.back() = 10;
+  cache.Insert(OutputCache::MakeKey(7, {MakeInput("INPUT", data1)}), MakeEntry(10, 'a'));
+  REQUIRE(cache.GetStats().bytes == 19u);
+
+  REQUIRE(cache.Find(7, {MakeInput("INPUT", data2)}) == nullptr);
+  REQUIRE(cache.Find(7, {MakeInput("OTHER", data1)}) == nullptr);
+  auto reshaped = MakeInput("INPUT", data1);
+  reshaped.meta.shape = TensorListShape<>::make_uniform(3, TensorShape<>(3));
+  REQUIRE(cache.Find(7, {reshaped}) == nullptr);
+  REQUIRE(cache.Find(7, {MakeInput("INPUT", data1), MakeInput("INPUT", data1)}) == nullptr);
+  REQUIRE(cache.GetStats().misses == 4u);
+
+  auto entry = cache.Find(7, {MakeInput("INPUT", data1)});
+  REQUIRE(entry);
+  REQUIRE((*entry)[0].data[0] == 'a');
+  REQUIRE(cache.GetStats().hits == 1u);
+
+  SECTION("Inputs split into many buffers") {
+    auto split = MakeInput("INPUT", data1);
+    split.buffers[0].size = 4;
+    auto rest = split.buffers[0];
+    rest.data = data1.data() + 4;
+    rest.size = data1.size() - 4;
+    split.buffers.push_back(rest);
+    REQUIRE(cache.Find(7, {split}));
+    split.buffers.pop_back();
+    REQUIRE(cache.Find(7, {split}) == nullptr);
+  }
+}
+
+TEST_CASE("Hashing inputs") {
+  std::vector<uint8_t> data1 = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  std::vector<uint8_t> data2 = data1;
+  auto hash = HashInputs({MakeInput("INPUT", data1)});
+  REQUIRE(hash != 0u);
+  REQUIRE(HashInputs({MakeInput("INPUT", data2)}) == hash);
+  REQUIRE(HashInputs({MakeInput("OTHER", data2)}) != hash);
+
+  auto reshaped = MakeInput("INPUT", data2);
+  reshaped.meta.shape = TensorListShape<>::make_uniform(3, TensorShape<>(3));
+  REQUIRE(HashInputs({reshaped}) != hash);
+
+  data2.back() = 10;
+  REQUIRE(HashInputs({MakeInput("INPUT", data2)}) != hash);
+
+  REQUIRE(HashInputs({MakeInput("INPUT", data1, device_type_t::GPU)}) == 0u);
+}
+
+TEST_CASE("Hashing data") {
+  std::string blob1 = "serialized pipeline", blob2 = blob1;
+  REQUIRE(HashData(blob1.data(), blob1.size()) == HashData(blob2.data(), blob2.size()));
+  blob2.back() = 'E';
+  REQUIRE(HashData(blob1.data(), blob1.size()) != HashData(blob2.data(), blob2.size()));
+  REQUIRE(HashData(blob1.data(), blob1.size() - 1) != HashData(blob1.data(), blob1.size()));
+  REQUIRE(HashData(nullptr, 0) == HashData(blob1.data(), 0));
+  REQUIRE(HashData(nullptr, 0) != HashData(blob1.data(), 1));
+}
+
+}}}}  // namespace triton::backend::dali::test
@@ -119,6 +119,34 @@ const unsigned char scale_pipeline_str[] = {
     0xff, 0xff, 0xff, 0x1};
 unsigned int scale_pipeline_len = 372;
 
+// The scale pipeline with the input and the operator on the GPU
+const unsigned char scale_gpu_pipeline_str[] = {
+    0x8,  0x1,  0x10, 0x2,  0x2a, 0x45, 0xa,  0xf,  0x5f, 0x45, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x61,
+    0x6c, 0x53, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x1a, 0xf,  0xa,  0x6,  0x49, 0x4e, 0x50, 0x55, 0x54,
+    0x30, 0x12, 0x3,  0x67, 0x70, 0x75, 0x18, 0x0,  0x22, 0x17, 0xa,  0x6,  0x64, 0x65, 0x76, 0x69,
+    0x63, 0x65, 0x12, 0x6,  0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x2a, 0x3,  0x67, 0x70, 0x75, 0x40,
+    0x0,  0x2a, 0x6,  0x49, 0x4e, 0x50, 0x55, 0x54, 0x30, 0x30, 0x0,  0x2a, 0xf7, 0x1,  0xa,  0x13,
+    0x41, 0x72, 0x69, 0x74, 0x68, 0x6d, 0x65, 0x74, 0x69, 0x63, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x69,
+    0x63, 0x4f, 0x70, 0x12, 0xf,  0xa,  0x6,  0x49, 0x4e, 0x50, 0x55, 0x54, 0x30, 0x12, 0x3,  0x67,
+    0x70, 0x75, 0x18, 0x0,  0x1a, 0x20, 0xa,  0x17, 0x5f, 0x5f, 0x41, 0x72, 0x69, 0x74, 0x68, 0x6d,
+    0x65, 0x74, 0x69, 0x63, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x69, 0x63, 0x4f, 0x70, 0x5f, 0x31, 0x12,
+    0x3,  0x67, 0x70, 0x75, 0x18, 0x0,  0x22, 0x2d, 0xa,  0xf,  0x65, 0x78, 0x70, 0x72, 0x65, 0x73,
+    0x73, 0x69, 0x6f, 0x6e, 0x5f, 0x64, 0x65, 0x73, 0x63, 0x12, 0x6,  0x73, 0x74, 0x72, 0x69, 0x6e,
+    0x67, 0x2a, 0x10, 0x6d, 0x75, 0x6c, 0x28, 0x26, 0x30, 0x20, 0x24, 0x30, 0x3a, 0x69, 0x6e, 0x74,
+    0x33, 0x32, 0x29, 0x40, 0x0,  0x22, 0x34, 0xa,  0x11, 0x69, 0x6e, 0x74, 0x65, 0x67, 0x65, 0x72,
+    0x5f, 0x63, 0x6f, 0x6e, 0x73, 0x74, 0x61, 0x6e, 0x74, 0x73, 0x12, 0x5,  0x69, 0x6e, 0x74, 0x36,
+    0x34, 0x3a, 0x16, 0xa,  0x9,  0x65, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x20, 0x30, 0x12, 0x5,
+    0x69, 0x6e, 0x74, 0x36, 0x34, 0x20, 0x2,  0x40, 0x0,  0x40, 0x1,  0x22, 0x17, 0xa,  0x6,  0x64,
+    0x65, 0x76, 0x69, 0x63, 0x65, 0x12, 0x6,  0x73, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x2a, 0x3,  0x67,
+    0x70, 0x75, 0x40, 0x0,  0x22, 0x14, 0xa,  0x8,  0x70, 0x72, 0x65, 0x73, 0x65, 0x72, 0x76, 0x65,
+    0x12, 0x4,  0x62, 0x6f, 0x6f, 0x6c, 0x30, 0x0,  0x40, 0x0,  0x2a, 0x17, 0x5f, 0x5f, 0x41, 0x72,
+    0x69, 0x74, 0x68, 0x6d, 0x65, 0x74, 0x69, 0x63, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x69, 0x63, 0x4f,
+    0x70, 0x5f, 0x31, 0x30, 0x1,  0x3a, 0x20, 0xa,  0x17, 0x5f, 0x5f, 0x41, 0x72, 0x69, 0x74, 0x68,
+    0x6d, 0x65, 0x74, 0x69, 0x63, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x69, 0x63, 0x4f, 0x70, 0x5f, 0x31,
+    0x12, 0x3,  0x67, 0x70, 0x75, 0x18, 0x0,  0x40, 0x0,  0x48, 0xd4, 0x85, 0xf9, 0xf9, 0xfd, 0xff,
+    0xff, 0xff, 0xff, 0x1};
+unsigned int scale_gpu_pipeline_len = 372;
+
 }  // namespace pipelines
 
 namespace data {
@@ -0,0 +1,74 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <catch2/catch.hpp>
+
+#include "src/utils/timing.h"
+
+namespace triton { namespace backend { namespace dali { namespace test {
+
+TEST_CASE("Latency histogram buckets") {
+  auto quantile_of = [](int64_t duration_ns) {
+    LatencyHistogram hist;
+    hist.Record(duration_ns);
+    return hist.QuantileUs(1);
+  };
+  REQUIRE(quantile_of(0) == 1);
+  REQUIRE(quantile_of(999) == 1);
+  REQUIRE(quantile_of(1000) == 2);
+  REQUIRE(quantile_of(1999) == 2);
+  REQUIRE(quantile_of(2000) == 4);
+  REQUIRE(quantile_of(3999) == 4);
+  REQUIRE(quantile_of(4000) == 8);
+  REQUIRE(quantile_of(int64_t(1) << 62) == (int64_t(1) << (LatencyHistogram::kNumBuckets - 1)));
+}
+
+TEST_CASE("Latency histogram quantiles") {
+  LatencyHistogram hist;
+  REQUIRE(hist.Count() == 0);
+  REQUIRE(hist.MeanUs() == 0);
+  for (int i = 0; i < 90; ++i) {
+    hist.Record(1000);
+  }
+  for (int i = 0; i < 9; ++i) {
+    hist.Record(100000);
+  }
+  hist.Record(10000000);
+  REQUIRE(hist.Count() == 100);
+  REQUIRE(hist.MeanUs() == 109);
+  REQUIRE(hist.QuantileUs(0.5) == 2);
+  REQUIRE(hist.QuantileUs(0.9) == 2);
+  REQUIRE(hist.QuantileUs(0.99) == 128);
+  REQUIRE(hist.QuantileUs(1) == 16384);
+}
+
+TEST_CASE("Stage latencies summary") {
+  StageLatencies latencies({"queue", "run"});
+  latencies.Record(0, 1500);
+  latencies.Record(1, 3000);
+  latencies.Record(1, 5000);
+  REQUIRE(latencies.Summary() ==
+          "queue: n=1 mean=1 p50<=2 p90<=2 p99<=2; run: n=2 mean=4 p50<=4 p90<=8 p99<=8");
+}
+
+}}}}  // namespace triton::backend::dali::test
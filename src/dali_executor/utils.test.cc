@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2021 NVIDIA CORPORATION
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <catch2/catch.hpp>
+
+#include "src/dali_executor/utils/utils.h"
+
+namespace triton { namespace backend { namespace dali { namespace test {
+
+TEST_CASE("Parse integers") {
+  REQUIRE(from_string<int>("42") == 42);
+  REQUIRE(from_string<int>("-1") == -1);
+  REQUIRE(from_string<int64_t>("8589934592") == (int64_t(1) << 33));
+  REQUIRE_THROWS(from_string<int>(""));
+  REQUIRE_THROWS(from_string<int>("12abc"));
+  REQUIRE_THROWS(from_string<int>("1.5"));
+  REQUIRE_THROWS(from_string<int>("8589934592"));
+}
+
+TEST_CASE("Parse bools") {
+  REQUIRE(from_string<bool>("true"));
+  REQUIRE(from_string<bool>("1"));
+  REQUIRE(!from_string<bool>("false"));
+  REQUIRE_THROWS(from_string<bool>("yes"));
+}
+
+TEST_CASE("Parse sizes") {
+  REQUIRE(parse_size("4096") == 4096);
+  REQUIRE(parse_size("100B") == 100);
+  REQUIRE(parse_size("512KB") == 512 << 10);
+  REQUIRE(parse_size("64MiB") == 64 << 20);
+  REQUIRE(parse_size("2G") == (int64_t(2) << 30));
+  REQUIRE_THROWS(parse_size(""));
+  REQUIRE_THROWS(parse_size("MB"));
+  REQUIRE_THROWS(parse_size("10XB"));
+  REQUIRE_THROWS(parse_size("-1K"));
+  REQUIRE_THROWS(parse_size("99999999999999G"));
+}
+
+TEST_CASE("Bucket by size") {
+  std::vector<size_t> order;
+  std::vector<size_t> sizes = {1000, 10, 40, 3000, 20, 10};
+  auto ends = bucket_by_size(sizes, 4, order);
+  REQUIRE(order == std::vector<size_t>{1, 5, 4, 2, 0, 3});
+  REQUIRE(ends == std::vector<size_t>{4, 6});
+
+  ends = bucket_by_size(sizes, 1000, order);
+  REQUIRE(ends == std::vector<size_t>{6});
+
+  ends = bucket_by_size({0, 0, 1, 8}, 4, order);
+  REQUIRE(ends == std::vector<size_t>{3, 4});
+
+  REQUIRE(bucket_by_size({}, 4, order).empty());
+}
+
+TEST_CASE("Permute") {
+  std::vector<std::string> items = {"a", "b", "c", "d"};
+  permute(items, {2, 0, 3, 1});
+  REQUIRE(items == std::vector<std::string>{"c", "a", "d", "b"});
+}
+
+TEST_CASE("Linear estimate") {
+  LinearEstimate estimate;
+  REQUIRE(estimate.Predict(100) == 0);
+
+  // A single small point doesn't make large inputs need proportionally more
+  estimate.Add(10, 1000);
+  REQUIRE(estimate.Predict(1000) == Approx(1000));
+
+  estimate.Add(20, 1020);
+  estimate.Add(40, 1060);
+  REQUIRE(estimate.Count() == 3u);
+  REQUIRE(estimate.Predict(1000) == Approx(2980));
+  REQUIRE(estimate.Predict(0) == Approx(980));
+
+  SECTION("Recent points weigh more") {
+    for (int i = 0; i < 200; ++i) {
+      estimate.Add(10, 100);
+      estimate.Add(20, 200);
+    }
+    REQUIRE(estimate.Predict(1000) == Approx(10000).epsilon(0.01));
+  }
+
+}
+
+TEST_CASE("Linear estimate of decreasing points") {
+  LinearEstimate estimate;
+  estimate.Add(10, 100);
+  estimate.Add(20, 50);
+  REQUIRE(estimate.Predict(1000) == Approx(estimate.Predict(0)));
+  REQUIRE(estimate.Predict(1000) > 50);
+  REQUIRE(estimate.Predict(1000) < 100);
+}
+
+}}}}  // namespace triton::backend::dali::test
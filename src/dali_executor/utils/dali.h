@@ -24,6 +24,7 @@
 #define DALI_BACKEND_UTILS_DALI_H_
 
 #include <dali/c_api.h>
+#include <dali/core/cuda_event.h>
 #include <dali/core/cuda_stream.h>
 #include <dali/core/dev_buffer.h>
 #include <dali/core/device_guard.h>
@@ -33,6 +34,7 @@
 #include <dali/core/tensor_shape_print.h>
 #include <dali/core/unique_handle.h>
 #include <dali/core/util.h>
+#include <dali/kernels/common/scatter_gather.h>
 #include <dali/operators.h>
 #include <dali/pipeline/util/thread_pool.h>
 
@@ -42,6 +44,7 @@ using ::dali::copyD2D;
 using ::dali::copyD2H;
 using ::dali::copyH2D;
 using ::dali::copyH2H;
+using ::dali::CUDAEvent;
 using ::dali::CUDAStream;
 using ::dali::DALIException;
 using ::dali::DeviceBuffer;
@@ -49,6 +52,7 @@ using ::dali::DeviceGuard;
 using ::dali::make_cspan;
 using ::dali::make_span;
 using ::dali::make_string;
+using ::dali::kernels::ScatterGatherGPU;
 using ::dali::span;
 using ::dali::TensorListShape;
 using ::dali::TensorShape;
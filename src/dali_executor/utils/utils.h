@@ -23,6 +23,13 @@
 #ifndef DALI_BACKEND_UTILS_UTILS_H_
 #define DALI_BACKEND_UTILS_UTILS_H_
 
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
 #include <cuda_runtime_api.h>
 #include "src/dali_executor/utils/dali.h"
 #include "src/error_handling.h"
@@ -32,7 +39,7 @@
 namespace triton { namespace backend { namespace dali {
 
 template<int ndims = -1>
-TensorShape<ndims> max(TensorListShape<ndims> tls) {
+TensorShape<ndims> max(const TensorListShape<ndims> &tls) {
   TensorShape<ndims> max = tls.tensor_shape(0);
   for (int i = 1; i < tls.num_samples(); i++) {
     max = tls.tensor_shape(i).num_elements() > max.num_elements() ? tls.tensor_shape(i) : max;
@@ -46,7 +53,7 @@ TensorShape<ndims> max(TensorListShape<ndims> tls) {
  * [ batch_size, max_volume(TensorListShape)... ]
  */
 template<int ndims = -1>
-std::vector<int64_t> array_shape(TensorListShape<ndims> tls) {
+std::vector<int64_t> array_shape(const TensorListShape<ndims> &tls) {
   std::vector<int64_t> ret(tls.sample_dim() + 1);
   auto max_ts = max(tls);
   ret[0] = tls.num_samples();
@@ -56,6 +63,52 @@ std::vector<int64_t> array_shape(TensorListShape<ndims> tls) {
   return ret;
 }
 
+/**
+ * Writes the array shape (see above) of the samples [begin, end) of \p tls to \p out.
+ * Doesn't allocate, if \p out is large enough already.
+ */
+template<int ndims = -1>
+void array_shape(const TensorListShape<ndims> &tls, int64_t begin, int64_t end,
+                 std::vector<int64_t> &out) {
+  out.resize(tls.sample_dim() + 1);
+  out[0] = end - begin;
+  if (begin == end) {
+    std::fill(out.begin() + 1, out.end(), 0);
+    return;
+  }
+  int64_t max_idx = begin;
+  for (int64_t i = begin + 1; i < end; i++) {
+    if (volume(tls.tensor_shape_span(i)) > volume(tls.tensor_shape_span(max_idx)))
+      max_idx = i;
+  }
+  auto max_ts = tls.tensor_shape_span(max_idx);
+  for (size_t i = 1; i < out.size(); i++) {
+    out[i] = max_ts[i - 1];
+  }
+}
+
+/**
+ * Appends \p num_samples samples of the \p sample_shape to \p tls.
+ * Doesn't allocate, if \p tls has the capacity for the samples already.
+ */
+template<int ndims = -1, typename SampleShape>
+void append_uniform(TensorListShape<ndims> &tls, int64_t num_samples,
+                    const SampleShape &sample_shape) {
+  int64_t offset = tls.num_samples();
+  int sample_dim = sample_shape.size();
+  if (offset == 0) {
+    tls.resize(num_samples, sample_dim);
+  } else {
+    ENFORCE(tls.sample_dim() == sample_dim,
+            make_string("Cannot append samples with ", sample_dim,
+                        " dimensions to a shape list with ", tls.sample_dim(), " dimensions."));
+    tls.resize(offset + num_samples);
+  }
+  for (int64_t i = 0; i < num_samples; i++) {
+    tls.set_tensor_shape(offset + i, sample_shape);
+  }
+}
+
 template<typename Container, int Dims = -1>
 TensorListShape<Dims> cat_list_shapes(const Container &shapes) {
   if (shapes.empty())
@@ -105,11 +158,163 @@ std::vector<TensorListShape<Dims>> split_list_shape(const TensorListShape<Dims>
 template<typename T>
 T from_string(const std::string &str);
 
+/**
+ * @brief Parse a whole string as a decimal integer. Trailing characters are an error.
+ */
+template<>
+inline int64_t from_string<int64_t>(const std::string &str) {
+  size_t pos = 0;
+  int64_t value = 0;
+  try {
+    value = std::stoll(str, &pos);
+  } catch (std::exception &) {
+    pos = 0;
+  }
+  if (pos == 0 || pos != str.size())
+    throw DaliBackendException(make_string("Cannot convert \"", str, "\" to an integer."));
+  return value;
+}
+
 template<>
 inline int from_string<int>(const std::string &str) {
-  return std::stoi(str);
+  auto value = from_string<int64_t>(str);
+  if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max())
+    throw DaliBackendException(make_string("Value ", str, " is out of the range of int."));
+  return value;
+}
+
+template<>
+inline bool from_string<bool>(const std::string &str) {
+  if (str == "true" || str == "1")
+    return true;
+  if (str == "false" || str == "0")
+    return false;
+  throw DaliBackendException(make_string("Cannot convert \"", str, "\" to bool."));
+}
+
+template<>
+inline std::string from_string<std::string>(const std::string &str) {
+  return str;
+}
+
+/**
+ * @brief Parse a size in bytes, e.g. "4096", "512KB", "64MiB" or "1G".
+ *
+ * The suffixes K, M and G (optionally followed by B or iB) denote the powers of 1024.
+ */
+inline int64_t parse_size(const std::string &str) {
+  size_t digits = 0;
+  while (digits < str.size() && std::isdigit(static_cast<unsigned char>(str[digits])))
+    digits++;
+  auto suffix = str.substr(digits);
+  int shift = -1;
+  if (suffix.empty() || suffix == "B")
+    shift = 0;
+  else if (suffix == "K" || suffix == "KB" || suffix == "KiB")
+    shift = 10;
+  else if (suffix == "M" || suffix == "MB" || suffix == "MiB")
+    shift = 20;
+  else if (suffix == "G" || suffix == "GB" || suffix == "GiB")
+    shift = 30;
+  if (digits == 0 || shift < 0)
+    throw DaliBackendException(make_string("Cannot convert \"", str, "\" to a size."));
+  auto value = from_string<int64_t>(str.substr(0, digits));
+  if (value > (std::numeric_limits<int64_t>::max() >> shift))
+    throw DaliBackendException(make_string("Size ", str, " is too large."));
+  return value << shift;
+}
+
+/**
+ * @brief Order the items by their \p sizes and group them in buckets, in which the sizes
+ *        differ at most \p ratio times.
+ *
+ * @param[out] order Indices of the items, by ascending size. Items of the same size
+ *                   keep their order.
+ * @return Position (in the \p order) of the item following each bucket.
+ */
+inline std::vector<size_t> bucket_by_size(const std::vector<size_t> &sizes, size_t ratio,
+                                          std::vector<size_t> &order) {
+  order.resize(sizes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return sizes[a] < sizes[b]; });
+  std::vector<size_t> bucket_ends;
+  size_t bucket_min = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    auto size = sizes[order[i]];
+    if (i > 0 && size > std::max<size_t>(bucket_min, 1) * ratio) {
+      bucket_ends.push_back(i);
+      bucket_min = size;
+    } else if (i == 0) {
+      bucket_min = size;
+    }
+  }
+  if (!order.empty())
+    bucket_ends.push_back(order.size());
+  return bucket_ends;
 }
 
+/**
+ * @brief Rearrange the \p items, so that the i-th one is the one previously at \p order[i].
+ */
+template<typename T>
+void permute(std::vector<T> &items, const std::vector<size_t> &order) {
+  std::vector<T> permuted;
+  permuted.reserve(order.size());
+  for (auto idx : order) {
+    permuted.push_back(std::move(items[idx]));
+  }
+  items = std::move(permuted);
+}
+
+/**
+ * @brief Least-squares fit of `y = fixed + per_x * x` to observed points, in which
+ *        the older points weigh less and less, so that the fit follows the recent ones.
+ */
+class LinearEstimate {
+ public:
+  /**
+   * @param decay Weight of the previous points kept with each new one, in (0, 1].
+   */
+  explicit LinearEstimate(double decay = 0.95) : decay_(decay) {}
+
+  void Add(double x, double y) {
+    w_ = w_ * decay_ + 1;
+    x_ = x_ * decay_ + x;
+    y_ = y_ * decay_ + y;
+    xx_ = xx_ * decay_ + x * x;
+    xy_ = xy_ * decay_ + x * y;
+    count_++;
+  }
+
+  /**
+   * @brief Number of the points added so far.
+   */
+  size_t Count() const {
+    return count_;
+  }
+
+  /**
+   * @brief Predict y for a given \p x, never less than 0 (or than the mean of y,
+   *        while all the points have about the same x).
+   */
+  double Predict(double x) const {
+    if (w_ == 0)
+      return 0;
+    double mean_x = x_ / w_, mean_y = y_ / w_;
+    double var_x = xx_ / w_ - mean_x * mean_x;
+    double per_x = 0;
+    if (var_x > 1e-6 * mean_x * mean_x)
+      per_x = std::max(0.0, (xy_ / w_ - mean_x * mean_y) / var_x);
+    return std::max(0.0, mean_y + per_x * (x - mean_x));
+  }
+
+ private:
+  double decay_;
+  double w_ = 0, x_ = 0, y_ = 0, xx_ = 0, xy_ = 0;  // decayed sums of weights and of the points
+  size_t count_ = 0;
+};
+
 // Basic timerange for profiling
 struct TimeRange {
   static const uint32_t kRed = 0xFF0000;
@@ -158,6 +363,17 @@ struct TimeRange {
   bool started = false;
 };
 
+/**
+ * @brief Mark the rest of the scope with an NVTX range, when built with TRITON_DALI_ENABLE_NVTX.
+ *
+ * Otherwise the macro expands to nothing and the name is not even evaluated.
+ */
+#ifdef TRITON_DALI_NVTX
+#define TRITON_DALI_RANGE(var, name, rgb) TimeRange var(name, rgb)
+#else
+#define TRITON_DALI_RANGE(var, name, rgb)
+#endif
+
 }}}  // namespace triton::backend::dali
 
 #endif  // DALI_BACKEND_UTILS_UTILS_H_
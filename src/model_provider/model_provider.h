@@ -24,7 +24,8 @@
 #define DALI_BACKEND_MODEL_PROVIDER_MODEL_PROVIDER_H_
 
 #include <fstream>
-#include <sstream>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
 
@@ -32,7 +33,15 @@ namespace triton { namespace backend { namespace dali {
 
 class ModelProvider {
  public:
-  virtual const std::string& GetModel() const = 0;
+  /**
+   * @brief Get a read-only view of the serialized model.
+   *
+   * The view is shared by all the users and stays valid as long as anybody holds it,
+   * even after the provider is destroyed.
+   */
+  virtual std::shared_ptr<const char> GetModel() const = 0;
+
+  virtual size_t GetModelSize() const = 0;
 
   virtual ~ModelProvider() = default;
 };
@@ -43,40 +52,63 @@ class FunctorModelProvider : public ModelProvider {
  public:
   template<typename... Args>
   explicit FunctorModelProvider(Args&&... args) :
-      functor_(), serialized_model_(functor_(std::forward<Args>(args)...)) {}
+      functor_(),
+      serialized_model_(std::make_shared<std::string>(functor_(std::forward<Args>(args)...))) {}
+
+  std::shared_ptr<const char> GetModel() const override {
+    return std::shared_ptr<const char>(serialized_model_, serialized_model_->data());
+  }
 
-  const std::string& GetModel() const override {
-    return serialized_model_;
+  size_t GetModelSize() const override {
+    return serialized_model_->size();
   }
 
   ~FunctorModelProvider() override = default;
 
   ModelFunctor functor_;
-  std::string serialized_model_;
+  std::shared_ptr<const std::string> serialized_model_;
 };
 
 
+/**
+ * @brief Provides the serialized model from a file.
+ *
+ * The file is read once, into a buffer shared by all the users of the model. The file isn't
+ * kept open or mapped, so it can be overwritten (e.g. before a reload) while the model serves.
+ */
 class FileModelProvider : public ModelProvider {
  public:
   FileModelProvider() = default;
 
   explicit FileModelProvider(const std::string& filename) {
-    std::ifstream fin(filename, std::ios::binary);
+    std::ifstream fin(filename, std::ios::binary | std::ios::ate);
     if (!fin)
       throw std::runtime_error(std::string("Failed to open serialized model file: ") + filename);
-    std::stringstream ss;
-    ss << fin.rdbuf();
-    model_ = ss.str();
+    auto size = static_cast<std::streamoff>(fin.tellg());
+    if (size < 0)
+      throw std::runtime_error(std::string("Failed to read serialized model file: ") + filename);
+    fin.seekg(0);
+    auto content = std::make_shared<std::string>(static_cast<size_t>(size), '\0');
+    fin.read(&(*content)[0], size);
+    // The file might have been truncated meanwhile
+    content->resize(fin.gcount());
+    size_ = content->size();
+    model_ = std::shared_ptr<const char>(content, content->data());
   }
 
-  const std::string& GetModel() const override {
+  std::shared_ptr<const char> GetModel() const override {
     return model_;
   }
 
+  size_t GetModelSize() const override {
+    return size_;
+  }
+
   ~FileModelProvider() override = default;
 
  private:
-  std::string model_ = {};
+  std::shared_ptr<const char> model_ = {};
+  size_t size_ = 0;
 };
 
 }}}  // namespace triton::backend::dali
@@ -20,8 +20,18 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#ifndef DALI_BACKEND_UTILS_TIMING_H_
+#define DALI_BACKEND_UTILS_TIMING_H_
+
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace triton { namespace backend { namespace dali {
 
@@ -43,4 +53,94 @@ inline void end_timer_ns(TimeInterval &interval) {
   interval.end = capture_time();
 }
 
+inline int64_t duration_ns(const TimeInterval &interval) {
+  return interval.end - interval.start;
+}
+
+/**
+ * @brief Histogram of durations in buckets growing by powers of 2.
+ *
+ * Bucket 0 counts durations below 1us, bucket i counts durations in [2^(i-1), 2^i) us.
+ * Recording is lock-free, so the histogram can be updated from many threads.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kNumBuckets = 32;
+
+  void Record(int64_t duration_ns) {
+    int64_t us = duration_ns / 1000;
+    int bucket = 0;
+    while (us > 0 && bucket < kNumBuckets - 1) {
+      us >>= 1;
+      bucket++;
+    }
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(duration_ns, std::memory_order_relaxed);
+  }
+
+  int64_t Count() const {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  int64_t MeanUs() const {
+    auto count = Count();
+    return count > 0 ? total_ns_.load(std::memory_order_relaxed) / count / 1000 : 0;
+  }
+
+  /**
+   * @brief Get the upper bound (in microseconds) of the bucket holding the quantile \p q.
+   */
+  int64_t QuantileUs(double q) const {
+    auto count = Count();
+    int64_t seen = 0;
+    for (int bucket = 0; bucket < kNumBuckets; ++bucket) {
+      seen += buckets_[bucket].load(std::memory_order_relaxed);
+      if (seen > 0 && seen >= q * count) {
+        return int64_t(1) << bucket;
+      }
+    }
+    return int64_t(1) << (kNumBuckets - 1);
+  }
+
+ private:
+  std::array<std::atomic<int64_t>, kNumBuckets> buckets_{};
+  std::atomic<int64_t> count_{0};
+  std::atomic<int64_t> total_ns_{0};
+};
+
+/**
+ * @brief Latency histograms of named processing stages.
+ */
+class StageLatencies {
+ public:
+  explicit StageLatencies(std::vector<std::string> stage_names) :
+      names_(std::move(stage_names)), histograms_(new LatencyHistogram[names_.size()]) {}
+
+  void Record(int stage, int64_t duration_ns) {
+    histograms_[stage].Record(duration_ns);
+  }
+
+  /**
+   * @brief Get a one-line summary of all the stages: number of samples, mean, p50, p90 and p99.
+   *        Quantiles are upper bounds of the histogram buckets. All times are in microseconds.
+   */
+  std::string Summary() const {
+    std::stringstream ss;
+    for (size_t stage = 0; stage < names_.size(); ++stage) {
+      auto &hist = histograms_[stage];
+      ss << (stage > 0 ? "; " : "") << names_[stage] << ": n=" << hist.Count()
+         << " mean=" << hist.MeanUs() << " p50<=" << hist.QuantileUs(0.5)
+         << " p90<=" << hist.QuantileUs(0.9) << " p99<=" << hist.QuantileUs(0.99);
+    }
+    return ss.str();
+  }
+
+ private:
+  std::vector<std::string> names_;
+  std::unique_ptr<LatencyHistogram[]> histograms_;
+};
+
 }}}  // namespace triton::backend::dali
+
+#endif  // DALI_BACKEND_UTILS_TIMING_H_
@@ -131,27 +131,96 @@ class TritonError : public UniqueHandle<TRITONSERVER_Error *, TritonError>, publ
   }
 };
 
+/** @brief Owning handle for a family of gauges reported in the metrics of the server. */
+class TritonGaugeFamily : public UniqueHandle<TRITONSERVER_MetricFamily *, TritonGaugeFamily> {
+ public:
+  DALI_INHERIT_UNIQUE_HANDLE(TRITONSERVER_MetricFamily *, TritonGaugeFamily)
+
+  static TritonGaugeFamily New(const char *name, const char *description) {
+    TRITONSERVER_MetricFamily *family;
+    TRITON_CALL(
+        TRITONSERVER_MetricFamilyNew(&family, TRITONSERVER_METRIC_KIND_GAUGE, name, description));
+    return TritonGaugeFamily(family);
+  }
+
+  static void DestroyHandle(TRITONSERVER_MetricFamily *family) {
+    LOG_IF_ERROR(TRITONSERVER_MetricFamilyDelete(family),
+                 make_string("Failed deleting a metric family."));
+  }
+};
+
+/**
+ * @brief Owning handle for a gauge with a given set of labels.
+ *
+ * Has to be destroyed before its family.
+ */
+class TritonGauge : public UniqueHandle<TRITONSERVER_Metric *, TritonGauge> {
+ public:
+  DALI_INHERIT_UNIQUE_HANDLE(TRITONSERVER_Metric *, TritonGauge)
+
+  static TritonGauge New(TRITONSERVER_MetricFamily *family,
+                         const std::vector<std::pair<std::string, std::string>> &labels) {
+    std::vector<const TRITONSERVER_Parameter *> params;
+    for (auto &label : labels) {
+      params.push_back(TRITONSERVER_ParameterNew(label.first.c_str(), TRITONSERVER_PARAMETER_STRING,
+                                                 label.second.c_str()));
+    }
+    TRITONSERVER_Metric *metric = nullptr;
+    auto error = TRITONSERVER_MetricNew(&metric, family, params.data(), params.size());
+    for (auto param : params) {
+      TRITONSERVER_ParameterDelete(const_cast<TRITONSERVER_Parameter *>(param));
+    }
+    TRITON_CALL(error);
+    return TritonGauge(metric);
+  }
+
+  void Set(double value) const {
+    LOG_IF_ERROR(TRITONSERVER_MetricSet(handle_, value), make_string("Failed setting a metric."));
+  }
+
+  static void DestroyHandle(TRITONSERVER_Metric *metric) {
+    LOG_IF_ERROR(TRITONSERVER_MetricDelete(metric), make_string("Failed deleting a metric."));
+  }
+};
+
 class TritonInput {
  public:
   TritonInput(TRITONBACKEND_Input *handle) : handle_(handle) {
     TRITONSERVER_DataType input_datatype;
-    const int64_t *input_shape;
-    uint32_t input_dims_count;
-    uint64_t input_byte_size;
-    uint32_t input_buffer_count;
-    const char *name;
-    TRITON_CALL(TRITONBACKEND_InputProperties(handle_, &name, &input_datatype, &input_shape,
-                                              &input_dims_count, &byte_size_, &buffer_cnt_));
-    meta_.name = std::string(name);
-    meta_.type = to_dali(input_datatype);
-    auto batch_size = input_shape[0];
-    auto sample_shape = TensorShape<>(input_shape + 1, input_shape + input_dims_count);
-    auto shape = TensorListShape<>::make_uniform(batch_size, sample_shape);
-    meta_.shape = shape;
+    TRITON_CALL(TRITONBACKEND_InputProperties(handle_, &name_, &input_datatype, &shape_,
+                                              &dims_count_, &byte_size_, &buffer_cnt_));
+    type_ = to_dali(input_datatype);
+    is_bytes_ = input_datatype == TRITONSERVER_TYPE_BYTES;
   }
 
   IOMeta Meta() const {
-    return meta_;
+    IOMeta meta{};
+    meta.name = std::string(name_);
+    meta.type = type_;
+    meta.shape = TensorListShape<>::make_uniform(BatchSize(), SampleShape());
+    return meta;
+  }
+
+  /**
+   * @brief Name of the input. Valid as long as the request.
+   */
+  const char *Name() const {
+    return name_;
+  }
+
+  dali_data_type_t Type() const {
+    return type_;
+  }
+
+  int64_t BatchSize() const {
+    return shape_[0];
+  }
+
+  /**
+   * @brief Shape of every sample of the input.
+   */
+  TensorShape<> SampleShape() const {
+    return TensorShape<>(shape_ + 1, shape_ + dims_count_);
   }
 
   size_t ByteSize() const {
@@ -162,6 +231,13 @@ class TritonInput {
     return buffer_cnt_;
   }
 
+  /**
+   * @brief Check if the input holds length-prefixed elements of variable size (TYPE_STRING).
+   */
+  bool IsBytes() const {
+    return is_bytes_;
+  }
+
   /**
    * @brief Request an input buffer.
    * @param idx Input index.
@@ -185,9 +261,13 @@ class TritonInput {
 
  private:
   TRITONBACKEND_Input *handle_ = nullptr;
-  IOMeta meta_{};
-  size_t byte_size_ = 0;
+  const char *name_ = nullptr;
+  dali_data_type_t type_{};
+  const int64_t *shape_ = nullptr;
+  uint32_t dims_count_ = 0;
+  uint64_t byte_size_ = 0;
   uint32_t buffer_cnt_ = 0;
+  bool is_bytes_ = false;
 };
 
 template<class Actual>
@@ -226,6 +306,24 @@ class TritonRequestWrapper {
     return TritonInput(input);
   }
 
+  /**
+   * @brief Get the ID of the sequence the request belongs to, 0 if it's not a part of one.
+   */
+  uint64_t CorrelationId() const {
+    uint64_t id;
+    TRITON_CALL(TRITONBACKEND_RequestCorrelationId(This(), &id));
+    return id;
+  }
+
+  /**
+   * @brief Get the flags of the request (TRITONSERVER_REQUEST_FLAG_SEQUENCE_START and _END).
+   */
+  uint32_t Flags() const {
+    uint32_t flags;
+    TRITON_CALL(TRITONBACKEND_RequestFlags(This(), &flags));
+    return flags;
+  }
+
  private:
   Actual &This() noexcept {
     return static_cast<Actual &>(*this);
@@ -292,12 +390,19 @@ template<class Actual>
 class TritonResponseWrapper {
  public:
   TritonOutput GetOutput(const IOMeta &out_info) const {
-    auto output_shape = array_shape(out_info.shape);
+    return GetOutput(out_info.name, out_info.type, array_shape(out_info.shape));
+  }
+
+  /**
+   * @brief Create an output of a given \p shape in the form returned by array_shape.
+   */
+  TritonOutput GetOutput(const std::string &name, dali_data_type_t type,
+                         const std::vector<int64_t> &output_shape) const {
     TRITONBACKEND_Output *triton_output;
-    TRITON_CALL(TRITONBACKEND_ResponseOutput(This(), &triton_output, out_info.name.c_str(),
-                                             to_triton(out_info.type), output_shape.data(),
+    TRITON_CALL(TRITONBACKEND_ResponseOutput(This(), &triton_output, name.c_str(),
+                                             to_triton(type), output_shape.data(),
                                              output_shape.size()));
-    auto t_size = TRITONSERVER_DataTypeByteSize(to_triton(out_info.type));
+    auto t_size = TRITONSERVER_DataTypeByteSize(to_triton(type));
     uint64_t buffer_size = volume(output_shape) * t_size;
     return TritonOutput(triton_output, buffer_size);
   }